@@ -0,0 +1,237 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "adjustment.hpp"
+
+#include <QtAlgorithms>
+
+#include <cstring>
+
+//! below this size comparison sort is faster than radix sort
+const int RADIX_MIN = 4096;
+
+//! bits sorted in one pass of radix sort
+const int RADIX_BITS = 16;
+const int RADIX_SIZE = 1 << RADIX_BITS;
+
+namespace adjustment
+{
+    struct IndexLessThan
+    {
+        IndexLessThan(const double *values)
+        {
+            this->values = values;
+        }
+
+        bool operator()(int i, int j) const
+        {
+            return values[i] < values[j];
+        }
+
+        const double *values;
+    };
+}
+
+QVector<int> adjustment::order(const QVector<double> &values)
+{
+    int n = values.size();
+
+    QVector<int> output(n);
+
+    for (int i=0; i<n; i++)
+    {
+        output[i] = i;
+    }
+
+    if (n<RADIX_MIN)
+    {
+        qSort(output.begin(), output.end(), IndexLessThan(values.constData()));
+
+        return output;
+    }
+
+    // bit patterns of non-negative doubles have the same order as the values
+    QVector<quint64> keys(n);
+    memcpy(keys.data(), values.constData(), n * sizeof(double));
+
+    QVector<quint64> keys_buffer(n);
+    QVector<int> index_buffer(n);
+    QVector<int> histogram(RADIX_SIZE);
+
+    quint64 *key_in = keys.data();
+    quint64 *key_out = keys_buffer.data();
+    int *index_in = output.data();
+    int *index_out = index_buffer.data();
+
+    for (int shift=0; shift<64; shift+=RADIX_BITS)
+    {
+        histogram.fill(0);
+
+        for (int i=0; i<n; i++)
+        {
+            histogram[(key_in[i] >> shift) & (RADIX_SIZE - 1)]++;
+        }
+
+        // skip digits shared by all values (i.e. exponent of p-values)
+        if (histogram.at((key_in[0] >> shift) & (RADIX_SIZE - 1))==n)
+        {
+            continue;
+        }
+
+        int total = 0;
+        for (int d=0; d<RADIX_SIZE; d++)
+        {
+            int count = histogram[d];
+            histogram[d] = total;
+            total += count;
+        }
+
+        for (int i=0; i<n; i++)
+        {
+            int position = histogram[(key_in[i] >> shift) & (RADIX_SIZE - 1)]++;
+
+            key_out[position] = key_in[i];
+            index_out[position] = index_in[i];
+        }
+
+        qSwap(key_in, key_out);
+        qSwap(index_in, index_out);
+    }
+
+    if (index_in!=output.data())
+    {
+        memcpy(output.data(), index_in, n * sizeof(int));
+    }
+
+    return output;
+}
+
+void adjustment::adjust(QVector<double> *pvalues, int method, int total)
+{
+    if (method==NOADJUSTMENT)
+    {
+        return;
+    }
+
+    // missing p-values do not count as hypotheses
+    QVector<int> valid;
+    QVector<double> p;
+
+    for (int i=0; i<pvalues->size(); i++)
+    {
+        double value = pvalues->at(i);
+
+        if (value==value)
+        {
+            valid.append(i);
+            p.append(value<0.0 ? 0.0 : value);
+        }
+    }
+
+    if (p.isEmpty())
+    {
+        return;
+    }
+
+    int n = qMax(p.size(), total);
+
+    QVector<int> sorted = order(p);
+    QVector<double> adjusted(p.size());
+
+    switch (method)
+    {
+    case HOLM:
+    {
+        // step-down: running maximum of (n-k) p(k)
+        double running = 0.0;
+        for (int k=0; k<p.size(); k++)
+        {
+            double value = qMin(1.0, (n - k) * p.at(sorted.at(k)));
+            running = qMax(running, value);
+            adjusted[k] = running;
+        }
+        break;
+    }
+    case HOCHBERG:
+    case BH:
+    {
+        // step-up: running minimum from the largest p-value
+        double running = 1.0;
+        for (int k=p.size()-1; k>=0; k--)
+        {
+            double factor = method==HOCHBERG ? (double)(n - k) : (double)n / (k + 1);
+            double value = qMin(1.0, factor * p.at(sorted.at(k)));
+            running = qMin(running, value);
+            adjusted[k] = running;
+        }
+        break;
+    }
+    }
+
+    for (int k=0; k<p.size(); k++)
+    {
+        (*pvalues)[valid.at(sorted.at(k))] = adjusted.at(k);
+    }
+}
+
+void adjustment::adjustTable(ResultsTable *table, int method)
+{
+    int n = table->rowCount();
+
+    // tables of comparisons with a reference have one column and no mirrored entries
+    bool symmetric = table->columnCount()==n;
+
+    QVector<double> pvalues;
+    QVector<int> rows;
+    QVector<int> entries;
+
+    for (int i=0; i<n; i++)
+    {
+        for (int k=table->begin(i); k<table->end(i); k++)
+        {
+            if ((!symmetric || table->columnAt(k)>i) && table->typeAt(k)==PV)
+            {
+                pvalues.append(table->valueAt(k));
+                rows.append(i);
+                entries.append(k);
+            }
+        }
+    }
+
+    // sparse tables keep only small p-values, the rest still counts as hypotheses
+    int total = -1;
+
+    if (table->isSparse())
+    {
+        total = symmetric ? n * (n - 1) / 2 : n - 1;
+    }
+
+    adjust(&pvalues, method, total);
+
+    for (int k=0; k<pvalues.size(); k++)
+    {
+        table->setValueAt(entries.at(k), pvalues.at(k));
+
+        if (symmetric)
+        {
+            table->setValue(table->columnAt(entries.at(k)), rows.at(k), pvalues.at(k));
+        }
+    }
+
+    table->info[3] = "Adjustment  = " + ADJUSTMENT.at(method);
+}
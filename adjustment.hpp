@@ -0,0 +1,66 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ADJUSTMENT_HPP
+#define ADJUSTMENT_HPP
+
+#include <QStringList>
+#include <QVector>
+
+#include "params.hpp"
+#include "resultstable.hpp"
+
+const QStringList ADJUSTMENT = (QStringList()
+                                << "None"
+                                << "Holm"
+                                << "Hochberg"
+                                << "Benjamini-Hochberg");
+
+namespace adjustment
+{
+    //! returns indices of values in ascending order of values (values must not be negative)
+    QVector<int> order(const QVector<double> &values);
+
+    /*!
+      replaces p-values with adjusted ones, NaN values are left untouched;
+      total is the number of hypotheses if only the smallest p-values are
+      given (Holm is then exact, step-up methods conservative)
+    */
+    void adjust(QVector<double> *pvalues, int method, int total = -1);
+
+    //! adjusts p-values of upper triangle of symmetric table and mirrors them
+    void adjustTable(ResultsTable *table, int method);
+
+    //! adjusts whole tables, for QtConcurrent::blockingMap
+    struct TableAdjuster
+    {
+        TableAdjuster(int method)
+        {
+            this->method = method;
+        }
+
+        void operator()(ResultsTable *&table) const
+        {
+            adjustTable(table, method);
+        }
+
+        int method;
+    };
+}
+
+#endif // ADJUSTMENT_HPP
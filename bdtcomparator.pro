@@ -11,7 +11,8 @@ unix {
 TEMPLATE = app
 
 FORMS   += mainwindow.ui \
-           aboutdialog.ui
+           aboutdialog.ui \
+           simulationdialog.ui
 
 SOURCES += main.cpp\
            mainwindow.cpp \
@@ -21,7 +22,19 @@ SOURCES += main.cpp\
            results.cpp \
            params.cpp \
            aboutdialog.cpp \
-           permutation.cpp
+           permutation.cpp \
+           permutationtest.cpp \
+           binarydata.cpp \
+           simulator.cpp \
+           simulationdialog.cpp \
+           adjustment.cpp \
+           jackknife.cpp \
+           formatter.cpp \
+           topk.cpp \
+           exporter.cpp \
+           cli.cpp \
+           cooccurrence.cpp \
+           strata.cpp
 
 HEADERS += \
            mainwindow.hpp \
@@ -31,9 +44,24 @@ HEADERS += \
            results.hpp \
            params.hpp \
            aboutdialog.hpp \
-           permutation.hpp
+           permutation.hpp \
+           permutationtest.hpp \
+           binarydata.hpp \
+           simulator.hpp \
+           simulationdialog.hpp \
+           adjustment.hpp \
+           jackknife.hpp \
+           formatter.hpp \
+           topk.hpp \
+           exporter.hpp \
+           cli.hpp \
+           cooccurrence.hpp \
+           strata.hpp
 
 # Add path to Boost library
 #INCLUDEPATH += BOOST_PATH
 
+# zlib for compressed output
+LIBS += -lz
+
 RESOURCES = resources.qrc
@@ -0,0 +1,164 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "binarydata.hpp"
+
+BinaryData::BinaryData(int n_rows, int n_cols)
+{
+    this->n_rows = n_rows;
+    this->n_cols = n_cols;
+    this->n_words = (n_rows + 63) / 64;
+
+    bits.fill(0ULL, n_cols * n_words);
+}
+
+BinaryData BinaryData::fromDataTable(const DataTable *data)
+{
+    int n_rows = data->rowCount();
+    int n_cols = data->columnCount();
+
+    int n_active = 0;
+
+    for (int i=0; i<n_rows; i++)
+    {
+        if (data->isActive(i))
+        {
+            n_active++;
+        }
+    }
+
+    BinaryData output(n_active, n_cols);
+
+    int r = 0;
+
+    for (int i=0; i<n_rows; i++)
+    {
+        if (!data->isActive(i))
+        {
+            continue;
+        }
+
+        QStringList row = data->row(i);
+
+        for (int j=0; j<n_cols; j++)
+        {
+            if (row.at(j).simplified()=="1")
+            {
+                output.set(r, j);
+            }
+        }
+
+        r++;
+    }
+
+    return output;
+}
+
+BinaryData BinaryData::agreement(int gc) const
+{
+    BinaryData output(n_rows, n_cols);
+
+    const quint64 *g = column(gc);
+
+    for (int j=0; j<n_cols; j++)
+    {
+        const quint64 *c = column(j);
+
+        for (int w=0; w<n_words; w++)
+        {
+            output.bits[j * n_words + w] = ~(c[w] ^ g[w]) & validBits(w);
+        }
+    }
+
+    return output;
+}
+
+BinaryData BinaryData::select(int gc, bool value) const
+{
+    int n_selected = value ? count(gc) : n_rows - count(gc);
+
+    BinaryData output(n_selected, n_cols);
+
+    int r = 0;
+
+    for (int i=0; i<n_rows; i++)
+    {
+        if (at(i, gc)!=value)
+        {
+            continue;
+        }
+
+        for (int j=0; j<n_cols; j++)
+        {
+            if (at(i, j))
+            {
+                output.set(r, j);
+            }
+        }
+
+        r++;
+    }
+
+    return output;
+}
+
+BinaryData BinaryData::inverted() const
+{
+    BinaryData output(n_rows, n_cols);
+
+    for (int j=0; j<n_cols; j++)
+    {
+        const quint64 *c = column(j);
+
+        for (int w=0; w<n_words; w++)
+        {
+            output.bits[j * n_words + w] = ~c[w] & validBits(w);
+        }
+    }
+
+    return output;
+}
+
+QVector<int> BinaryData::rowSums(int skip) const
+{
+    QVector<int> output(n_rows, 0);
+
+    for (int j=0; j<n_cols; j++)
+    {
+        if (j==skip)
+        {
+            continue;
+        }
+
+        const quint64 *c = column(j);
+
+        for (int w=0; w<n_words; w++)
+        {
+            quint64 word = c[w];
+
+            // visit set bits only
+            while (word)
+            {
+                output[w * 64 + trailingZeros(word)]++;
+                word &= word - 1ULL;
+            }
+        }
+    }
+
+    return output;
+}
@@ -0,0 +1,177 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARYDATA_HPP
+#define BINARYDATA_HPP
+
+#include <QVector>
+
+#include "datatable.hpp"
+
+//! returns number of ones in x
+inline int popcount(quint64 x)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+//! returns position of the lowest one in x (x must not be zero)
+inline int trailingZeros(quint64 x)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#else
+    return popcount((x & (~x + 1ULL)) - 1ULL);
+#endif
+}
+
+/*!
+  Bit-packed copy of binary data. Every column is stored as a sequence of
+  64-bit words, so cross-tabulation of two columns is a popcount of their
+  bitwise AND. Only active rows are kept.
+*/
+class BinaryData
+{
+public:
+    BinaryData(int n_rows = 0, int n_cols = 0);
+
+    //! packs active rows of data
+    static BinaryData fromDataTable(const DataTable *data);
+
+    int rowCount() const
+    {
+        return n_rows;
+    }
+
+    int columnCount() const
+    {
+        return n_cols;
+    }
+
+    bool at(int row, int col) const
+    {
+        return (bits.at(col * n_words + row / 64) >> (row % 64)) & 1ULL;
+    }
+
+    void set(int row, int col, bool value = true)
+    {
+        quint64 bit = 1ULL << (row % 64);
+
+        if (value)
+        {
+            bits[col * n_words + row / 64] |= bit;
+        }
+        else
+        {
+            bits[col * n_words + row / 64] &= ~bit;
+        }
+    }
+
+    //! returns number of ones in column x
+    int count(int x) const
+    {
+        const quint64 *c = column(x);
+        int output = 0;
+
+        for (int w=0; w<n_words; w++)
+        {
+            output += popcount(c[w]);
+        }
+
+        return output;
+    }
+
+    //! returns number of rows with ones in both columns i and j
+    int countBoth(int i, int j) const
+    {
+        const quint64 *ci = column(i);
+        const quint64 *cj = column(j);
+        int output = 0;
+
+        for (int w=0; w<n_words; w++)
+        {
+            output += popcount(ci[w] & cj[w]);
+        }
+
+        return output;
+    }
+
+    //! returns number of rows with ones in columns i, j and k
+    int countAll(int i, int j, int k) const
+    {
+        const quint64 *ci = column(i);
+        const quint64 *cj = column(j);
+        const quint64 *ck = column(k);
+        int output = 0;
+
+        for (int w=0; w<n_words; w++)
+        {
+            output += popcount(ci[w] & cj[w] & ck[w]);
+        }
+
+        return output;
+    }
+
+    const quint64 *column(int x) const
+    {
+        return bits.constData() + x * n_words;
+    }
+
+    //! returns data with ones where column agrees with column gc
+    BinaryData agreement(int gc) const;
+
+    //! returns rows with given value in column gc
+    BinaryData select(int gc, bool value) const;
+
+    //! returns data with zeros and ones swapped
+    BinaryData inverted() const;
+
+    //! returns sums of rows skipping column skip
+    QVector<int> rowSums(int skip = -1) const;
+
+private:
+    //! returns word with ones at valid positions of w-th word
+    quint64 validBits(int w) const
+    {
+        int rest = n_rows - w * 64;
+
+        if (rest>=64)
+        {
+            return ~0ULL;
+        }
+        else
+        {
+            return (1ULL << rest) - 1ULL;
+        }
+    }
+
+    int n_rows;
+    int n_cols;
+    int n_words;
+
+    //! columns one after another, n_words words each
+    QVector<quint64> bits;
+};
+
+#endif // BINARYDATA_HPP
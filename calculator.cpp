@@ -18,15 +18,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "calculator.hpp"
 
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
 Calculator::Calculator(DataTable *data, Results *results, Params *params, QObject *parent) :
     QObject(parent)
 {
     this->data = data;
     this->results = results;
     this->params = params;
+    this->source = params;
+    this->counts = NULL;
+    this->streaming = false;
+    this->lazy = false;
+    this->steps_done = 0;
+    this->steps_total = 0;
 }
 
-Entry Calculator::confidenceInterval(const double y, const double n)
+void Calculator::confidenceInterval(const double y, const double n, ResultsTable *out, int row, int col)
 {
     double alpha = 1.0 - params->getConfidenceLevel();
     double est, low, upp;
@@ -53,56 +64,23 @@ Entry Calculator::confidenceInterval(const double y, const double n)
     
     est = y / n;
 
-    QList<double> output;
-    output << est << low << upp;
-    
-    return Entry(CI, output);
+    out->set(row, col, CI, est, low, upp);
 }
 
-EntryList Calculator::confidenceIntervals(int column)
+void Calculator::confidenceIntervals(int column, int row, ResultsTable *out)
 {
-    double a = 0.0;
-    double b = 0.0;
-    double c = 0.0;
-    double d = 0.0;
-    
     int gc = params->getGoldStandard();
     
-    int n_rows = data->rowCount();
-    
-    for (int i=0; i<n_rows; i++)
-    {
-        if (!data->isActive(i))
-        {
-            continue;
-        }
-        
-        QStringList row = data->row(i);
-        
-        QString row_symbol;
-        row_symbol = "9" + row.at(gc) + row.at(column);
-        
-        switch (row_symbol.toInt())
-        {
-        case 911:
-            a++;
-            break;
-        case 901:
-            b++;
-            break;
-        case 910:
-            c++;
-            break;
-        case 900:
-            d++;
-        }
-    }
+    double a = counts ? counts->countBoth(gc, column) : bits.countBoth(gc, column);
+    double b = (counts ? counts->count(column) : bits.count(column)) - a;
+    double c = (counts ? counts->count(gc) : bits.count(gc)) - a;
+    double d = bits.rowCount() - a - b - c;
     
-    EntryList output;
+    int k = 0;
     
-    if (results->toCalculate(ACC)) output.append(confidenceInterval(a+d, a+b+c+d)); // Diagnostic accuracy
-    if (results->toCalculate(SEN)) output.append(confidenceInterval(  a, a+c    )); // Sensitivity
-    if (results->toCalculate(SPE)) output.append(confidenceInterval(  d, b+d    )); // Specificity
+    if (results->toCalculate(ACC)) confidenceInterval(a+d, a+b+c+d, out, row, k++); // Diagnostic accuracy
+    if (results->toCalculate(SEN)) confidenceInterval(  a, a+c    , out, row, k++); // Sensitivity
+    if (results->toCalculate(SPE)) confidenceInterval(  d, b+d    , out, row, k++); // Specificity
     
     if (a<0.5)
     {
@@ -121,8 +99,8 @@ EntryList Calculator::confidenceIntervals(int column)
         d = 0.1;
     }
     
-    if (results->toCalculate(PPV)) output.append(confidenceInterval(  a, a+b    )); // Positive Predictive Value
-    if (results->toCalculate(NPV)) output.append(confidenceInterval(  d, c+d    )); // Negative Predictive Value
+    if (results->toCalculate(PPV)) confidenceInterval(  a, a+b    , out, row, k++); // Positive Predictive Value
+    if (results->toCalculate(NPV)) confidenceInterval(  d, c+d    , out, row, k++); // Negative Predictive Value
     
     double q = 1.0 - ((1.0 - params->getConfidenceLevel()) / 2.0);
     double p1, p2;
@@ -136,12 +114,12 @@ EntryList Calculator::confidenceIntervals(int column)
         p1 = a / (a + c);
         p2 = b / (b + d);
         
-        QList<double> lrpos;
-        lrpos << p1 / p2;
-        lrpos << exp(log(lrpos.at(EST)) - z * sqrt((1 - p1) / a + (1 - p2) / b));
-        lrpos << exp(log(lrpos.at(EST)) + z * sqrt((1 - p1) / a + (1 - p2) / b));
+        double lrpos = p1 / p2;
         
-        output.append(Entry(CI, lrpos));
+        out->set(row, k++, CI,
+                 lrpos,
+                 exp(log(lrpos) - z * sqrt((1 - p1) / a + (1 - p2) / b)),
+                 exp(log(lrpos) + z * sqrt((1 - p1) / a + (1 - p2) / b)));
     }
     
     if (results->toCalculate(LRN))
@@ -149,94 +127,125 @@ EntryList Calculator::confidenceIntervals(int column)
         p1 = c / (a + c);
         p2 = d / (b + d);
         
-        QList<double> lrneg;
-        lrneg << p1 / p2;
-        lrneg << exp(log(lrneg.at(EST)) - z * sqrt((1 - p1) / c + (1 - p2) / d));
-        lrneg << exp(log(lrneg.at(EST)) + z * sqrt((1 - p1) / c + (1 - p2) / d));
+        double lrneg = p1 / p2;
         
-        output.append(Entry(CI, lrneg));
+        out->set(row, k++, CI,
+                 lrneg,
+                 exp(log(lrneg) - z * sqrt((1 - p1) / c + (1 - p2) / d)),
+                 exp(log(lrneg) + z * sqrt((1 - p1) / c + (1 - p2) / d)));
     }
-    
-    return output;
 }
 
-void Calculator::pairwiseComparision(QList<QStringList> *input, ResultsTable *out_pv, ResultsTable *out_ci)
+/*!
+  Predictive values for every prevalence of the grid from sensitivity and
+  specificity by Bayes' rule, confidence intervals by the logit method
+  (Mercaldo et al. 2007). Variance of logit does not depend on prevalence,
+  so for each test the grid is just shifted by its logit.
+*/
+void Calculator::prevalenceSweep(ResultsTable *out_ppv, ResultsTable *out_npv)
 {
-    int n_rows = input->length();
-    int n_cols = data->columnCount();
+    int gc = params->getGoldStandard();
+    int n_cols = bits.columnCount();
     
-    int m = n_cols - 1;
+    QVector<double> grid = params->getPrevalenceGrid();
+    int n_grid = grid.size();
     
-    int gc = params->getGoldStandard();
+    QVector<double> logit(n_grid);
     
-    double q = 1.0 - (params->getPvalue() / 2.0);
+    for (int k=0; k<n_grid; k++)
+    {
+        logit[k] = log(grid.at(k) / (1.0 - grid.at(k)));
+    }
+    
+    double q = 1.0 - ((1.0 - params->getConfidenceLevel()) / 2.0);
     
     boost::math::normal normal;
-    boost::math::chi_squared chisq1(1);
     
     double z = boost::math::quantile(normal, q);
     
-    QVector<double> row_sums(n_rows, 0.0);
-    QVector<double> col_sums(n_cols, 0.0);
-    
-    double sum = 0.0;
-    
-    for (int i=0; i<n_rows; i++)
+    for (int i=0; i<n_cols; i++)
     {
-        QStringList row = input->at(i);
-        
-        for (int j=0; j<n_cols; j++)
+        if (i==gc)
         {
-            if (j==gc)
-            {
-                continue;
-            }
-            
-            double value = row.at(j).toDouble();
-            
-            row_sums[i] += value;
-            col_sums[j] += value;
-            
-            sum += value;
+            continue;
         }
-    }
-        
-    if (m>2)
-    {
-        double cochran_Q;
         
-        boost::math::chi_squared chisq2(m-1);
+        int ir = i<gc ? i : i-1;
         
-        double row_sum_square = 0.0;
-        double col_sum_square = 0.0;
+        double a = counts ? counts->countBoth(gc, i) : bits.countBoth(gc, i);
+        double b = (counts ? counts->count(i) : bits.count(i)) - a;
+        double c = (counts ? counts->count(gc) : bits.count(gc)) - a;
+        double d = bits.rowCount() - a - b - c;
         
-        for (int i=0; i<n_rows; i++)
+        if (a<0.5)
         {
-            row_sum_square += row_sums[i] * row_sums[i];
+            a = 0.1;
         }
-        
-        for (int j=0; j<n_cols; j++)
+        if (b<0.5)
         {
-            col_sum_square += col_sums[j] * col_sums[j];
+            b = 0.1;
         }
-        
-        double denom = (m - 1) * (m * col_sum_square - sum * sum);
-        if (denom==0)
+        if (c<0.5)
         {
-            cochran_Q = 0.0;
+            c = 0.1;
         }
-        else
+        if (d<0.5)
         {
-            cochran_Q = denom / (m * sum - row_sum_square);
+            d = 0.1;
         }
         
-        double pvalue = 1.0 - boost::math::cdf(chisq2, cochran_Q);
+        double diseased = a + c;
+        double healthy = b + d;
         
-        out_pv->info[0] = "Cochran's Q = " + QString::number(cochran_Q, 'f', 2);
-        out_pv->info[1] = "p-value     = " + QString::number(pvalue, 'f', 4);
+        // logit(PPV) = log(Se / (1 - Sp)) + logit(prevalence)
+        double ppv_shift = log((a / diseased) / (b / healthy));
+        double ppv_err = z * sqrt(1.0 / a - 1.0 / diseased + 1.0 / b - 1.0 / healthy);
+        
+        // logit(NPV) = log(Sp / (1 - Se)) - logit(prevalence)
+        double npv_shift = log((d / healthy) / (c / diseased));
+        double npv_err = z * sqrt(1.0 / d - 1.0 / healthy + 1.0 / c - 1.0 / diseased);
+        
+        for (int k=0; k<n_grid; k++)
+        {
+            double ppv = ppv_shift + logit.at(k);
+            double npv = npv_shift - logit.at(k);
+            
+            out_ppv->set(ir, k, CI,
+                         1.0 / (1.0 + exp(-ppv)),
+                         1.0 / (1.0 + exp(-ppv + ppv_err)),
+                         1.0 / (1.0 + exp(-ppv - ppv_err)));
+            
+            out_npv->set(ir, k, CI,
+                         1.0 / (1.0 + exp(-npv)),
+                         1.0 / (1.0 + exp(-npv + npv_err)),
+                         1.0 / (1.0 + exp(-npv - npv_err)));
+        }
     }
+    
+    out_ppv->info[0] = "Conf. level = " + QString::number(params->getConfidenceLevel(), 'f', 4);
+    out_ppv->info[1] = "CI method   = logit";
+    out_npv->info[0] = out_ppv->info[0];
+    out_npv->info[1] = out_ppv->info[1];
+}
 
-    out_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+/*!
+  Jackknife standard errors of all measures of every test and of pairwise
+  differences of the selected measure. Influence of a row on a measure (or
+  on a difference) is (n - 1) times its change after leaving the row out;
+  for every measure and for the differences rows are ranked by the largest
+  influence relative to jackknife standard error.
+*/
+void Calculator::jackknifeStatistics(ResultsTable *out_se, ResultsTable *out_pc, ResultsTable **out_influence, ResultsTable *out_influence_pc)
+{
+    int gc = params->getGoldStandard();
+    int n_cols = bits.columnCount();
+    int n_rows = bits.rowCount();
+    int id = params->getJackknifeMeasure();
+    
+    // values of measure k of test i are at k * n_cols + i, leave-one-out ones for four cells each
+    QVector<double> loo(NRESULTS * n_cols * 4, 0.0);
+    QVector<double> se(NRESULTS * n_cols, 0.0);
+    QVector<double> estimate(NRESULTS * n_cols, 0.0);
     
     for (int i=0; i<n_cols; i++)
     {
@@ -245,116 +254,158 @@ void Calculator::pairwiseComparision(QList<QStringList> *input, ResultsTable *ou
             continue;
         }
         
-        EntryList row_pv;
-        EntryList row_ci;
-               
-        for (int j=0; j<n_cols; j++)
+        int ir = i<gc ? i : i-1;
+        int col = 0;
+        
+        double n[4];
+        jackknife::counts(&bits, gc, i, n);
+        
+        for (int k=0; k<NRESULTS; k++)
         {
-            if (j==gc)
+            if (!results->toCalculate(k))
             {
                 continue;
             }
             
-            if (i==j)
+            int x = k * n_cols + i;
+            
+            double values[4];
+            jackknife::leaveOneOut(k, n, values);
+            
+            double value = sqrt(jackknife::variance(n, values, 4));
+            out_se->set(ir, col++, NUM, value);
+            
+            for (int c=0; c<4; c++)
             {
-                row_pv.append(Entry());
-                row_ci.append(Entry());
-                continue;
+                loo[x * 4 + c] = values[c];
             }
             
-            double a = 0.0;
-            double b = 0.0;
-            double c = 0.0;
-            double d = 0.0;
+            se[x] = value;
+            estimate[x] = jackknife::measure(k, n[0], n[1], n[2], n[3]);
+        }
+    }
+    
+    out_se->info[0] = "Rows        = " + QString::number(n_rows);
+    
+    // one pass over rows per measure, influence only depends on the cell of the row
+    for (int k=0; k<NRESULTS; k++)
+    {
+        if (!results->toCalculate(k))
+        {
+            continue;
+        }
+        
+        QVector<double> score(n_rows, 0.0);
+        
+        for (int r=0; r<n_rows; r++)
+        {
+            bool gold = bits.at(r, gc);
             
-            for (int k=0; k<n_rows; k++)
+            for (int i=0; i<n_cols; i++)
             {
-                QStringList row = input->at(k);
-                
-                QString row_symbol;
-                row_symbol = "9" + row.at(i) + row.at(j);
+                int x = k * n_cols + i;
                 
-                switch (row_symbol.toInt())
+                if (i==gc || se.at(x)<=0.0)
                 {
-                case 911:
-                    a++;
-                    break;
-                case 901:
-                    b++;
-                    break;
-                case 910:
-                    c++;
-                    break;
-                case 900:
-                    d++;
+                    continue;
                 }
+                
+                double value = (n_rows - 1) * (estimate.at(x) - loo.at(x * 4 + jackknife::cell(bits.at(r, i), gold)));
+                
+                score[r] = qMax(score.at(r), fabs(value) / se.at(x));
             }
+        }
+        
+        QVector<int> top = influentialRows(score, out_influence[k]);
+        
+        for (int t=0; t<top.size(); t++)
+        {
+            int r = top.at(t);
+            bool gold = bits.at(r, gc);
             
-            double n = a + b + c + d;
-            
-            double mc;
-            
-            if (b+c<1.0)
+            for (int i=0; i<n_cols; i++)
             {
-                mc = 0.0;
+                if (i==gc)
+                {
+                    continue;
+                }
+                
+                int ir = i<gc ? i : i-1;
+                int x = k * n_cols + i;
+                
+                out_influence[k]->set(t, ir, NUM, (n_rows - 1) * (estimate.at(x) - loo.at(x * 4 + jackknife::cell(bits.at(r, i), gold))));
             }
-            else
+        }
+        
+        out_influence[k]->info[0] = "Measure     = " + HEADER[k];
+        out_influence[k]->info[1] = "Ranked by   = |influence| / SE";
+    }
+    
+    if (!results->toCalculate(id) || n_cols<=2)
+    {
+        return;
+    }
+    
+    /*
+      eight cells (gold standard x test i x test j) of pairs i < j are
+      counted once, in order of columns of influence table, and kept for
+      the passes below; cells of the pair j, i are the same counts with
+      tests exchanged
+    */
+    QVector<int> pair_counts;
+    pair_counts.reserve((n_cols - 1) * (n_cols - 2) / 2 * 8);
+    
+    for (int i=0; i<n_cols; i++)
+    {
+        if (i==gc)
+        {
+            continue;
+        }
+        
+        for (int j=i+1; j<n_cols; j++)
+        {
+            if (j==gc)
             {
-                mc = (abs(b - c) - 1.0);
-                mc = mc * mc / (b + c);
+                continue;
             }
             
-            QList<double> pval;
-            pval << 1.0 - boost::math::cdf(chisq1, mc);
-            
-            row_pv.append(Entry(PV, pval));
+            int ir = i<gc ? i : i-1;
+            int jr = j<gc ? j : j-1;
             
-            double p1 = col_sums[i] / n_rows;
-            double p2 = col_sums[j] / n_rows;
+            double n[8];
+            double swapped[8];
+            double values[8];
             
-            double std_err = sqrt(b + c - (b - c) * (b - c) / n) / n;
+            jackknife::counts(&bits, gc, i, j, n);
             
-            QList<double> ci;
-
-            double est = p1 - p2;
-
-            double low = est - z * std_err - 1.0 / n;
-            if (low<-1.0)
+            for (int c=0; c<8; c++)
             {
-                low = -1.0;
-            }
-
-            double upp = est + z * std_err + 1.0 / n;
-            if (upp>1.0)
-            {
-                upp = 1.0;
+                swapped[jackknife::cell(c & 1, c & 2, c & 4)] = n[c];
+                pair_counts.append((int)n[c]);
             }
-
-            ci << est << low << upp;
             
-            row_ci.append(Entry(CI, ci));
+            jackknife::leaveOneOutDifference(id, n, values);
+            out_pc->set(ir, jr, NUM, sqrt(jackknife::variance(n, values, 8)));
+            
+            jackknife::leaveOneOutDifference(id, swapped, values);
+            out_pc->set(jr, ir, NUM, sqrt(jackknife::variance(swapped, values, 8)));
         }
         
-        out_pv->appendRow(row_pv);
-        out_ci->appendRow(row_ci);
+        publish();
+        
+        if (isCancelled())
+        {
+            return;
+        }
     }
-}
-
-void Calculator::pairwisePredictiveValue(const ResultsTable *ci_table, ResultsTable *out_ppv_pv, ResultsTable *out_npv_pv, ResultsTable *out_ppv_ci, ResultsTable *out_npv_ci)
-{
-    int n_rows = data->rowCount();
-    int n_cols = data->columnCount();
     
-    int gc = params->getGoldStandard();
-    
-    double q = 1.0 - (params->getPvalue() / 2.0);
-    
-    out_ppv_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
-    out_npv_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    out_pc->info[0] = "Measure     = " + HEADER[id];
+    out_pc->info[1] = "Statistic   = SE of difference";
     
-    boost::math::normal normal;
+    // influence of rows on differences of pairs i < j, from leave-one-out values of eight cells
+    QVector<double> score(n_rows, 0.0);
     
-    double z = boost::math::quantile(normal, q);
+    int pair = 0;
     
     for (int i=0; i<n_cols; i++)
     {
@@ -363,151 +414,60 @@ void Calculator::pairwisePredictiveValue(const ResultsTable *ci_table, ResultsTa
             continue;
         }
         
-        EntryList row_ppv_pv;
-        EntryList row_npv_pv;
-        EntryList row_ppv_ci;
-        EntryList row_npv_ci;
-        
-        for (int j=0; j<n_cols; j++)
+        for (int j=i+1; j<n_cols; j++)
         {
             if (j==gc)
             {
                 continue;
             }
             
-            if (i==j)
-            {
-                row_ppv_pv.append(Entry());
-                row_npv_pv.append(Entry());
-                row_ppv_ci.append(Entry());
-                row_npv_ci.append(Entry());
-                continue;
-            }
-            
-            QVector<double> n(9, 0.0);
-            QVector<double> p(9, 0.0);
+            double n[8];
+            double values[8];
             
-            for (int k=0; k<n_rows; k++)
-            {
-                QStringList row = data->row(k);
-                
-                QString row_symbol;
-                row_symbol = "9" + row.at(gc) + row.at(i) + row.at(j);
-                
-                switch (row_symbol.toInt())
-                {
-                case 9011:
-                    n[1]++;
-                    break;
-                case 9010:
-                    n[2]++;
-                    break;
-                case 9001:
-                    n[3]++;
-                    break;
-                case 9000:
-                    n[4]++;
-                    break;
-                case 9111:
-                    n[5]++;
-                    break;
-                case 9110:
-                    n[6]++;
-                    break;
-                case 9101:
-                    n[7]++;
-                    break;
-                case 9100:
-                    n[8]++;
-                }
-            }
-                
-            for (int l=1; l<9; l++)
+            for (int c=0; c<8; c++)
             {
-                if (n[l]<0.5)
-                {
-                    n[l] = 0.1;
-                }
-                
-                n[0] += n[l];
-            }
-            
-            for (int l=1; l<9; l++)
-            {                   
-                p[l] = n[l] / n[0];
+                n[c] = pair_counts.at(pair * 8 + c);
             }
             
-            int ir = i<gc ? i : i-1;
-            int jr = j<gc ? j : j-1;
-            
-            double ppvi = ci_table->row(ir).at(PPV).value.at(EST);
-            double npvi = ci_table->row(ir).at(NPV).value.at(EST);
-            double ppvj = ci_table->row(jr).at(PPV).value.at(EST);
-            double npvj = ci_table->row(jr).at(NPV).value.at(EST);
-            
-            double rppv = ppvi / ppvj;
-            double rnpv = npvi / npvj;
-            
-            double sigma2_log_rppv
-                    = 1.0 / ((p[5] + p[7]) * (p[5] + p[6]))
-                    * (p[6] * (1.0 - ppvj)
-                       + p[5] * (ppvj - ppvi)
-                       + 2.0 * (p[7] + p[3]) * ppvi * ppvj
-                       + p[7] * (1.0 - 3.0 * ppvi));
+            pair++;
             
-            double sigma2_log_rnpv
-                    = (npvj * (p[4] - p[3] - 2.0 * (p[4] + p[8]) * npvi) + p[2] + p[3] - npvi * (p[2] - p[4])) / ((p[2] + p[4]) * (p[3] + p[4]));
+            jackknife::leaveOneOutDifference(id, n, values);
             
-            double ppvu = log(rppv) / sqrt(sigma2_log_rppv / n[0]);
-            double npvu = log(rnpv) / sqrt(sigma2_log_rnpv / n[0]);
+            double value = sqrt(jackknife::variance(n, values, 8));
             
-            QList<double> ppv_pv;
-            ppv_pv << 2.0 * (1.0 - boost::math::cdf(normal, fabs(ppvu)));
-            row_ppv_pv.append(Entry(PV, ppv_pv));
+            if (value<=0.0)
+            {
+                continue;
+            }
             
-            QList<double> npv_pv;
-            npv_pv << 2.0 * (1.0 - boost::math::cdf(normal, fabs(npvu)));
-            row_npv_pv.append(Entry(PV, npv_pv));
+            double difference = jackknife::difference(id, n);
+            double scores[8];
             
-            QList<double> ppv_ci;
-            double ppv_est = log(rppv);
-            double ppv_std_err = sqrt(sigma2_log_rppv / n[0]);
-            ppv_ci << exp(ppv_est);
-            ppv_ci << exp(ppv_est - z * ppv_std_err);
-            ppv_ci << exp(ppv_est + z * ppv_std_err);
-            row_ppv_ci.append(Entry(CI, ppv_ci));
+            for (int c=0; c<8; c++)
+            {
+                scores[c] = fabs((n_rows - 1) * (difference - values[c])) / value;
+            }
             
-            QList<double> npv_ci;
-            double npv_est = log(rnpv);
-            double npv_std_err = sqrt(sigma2_log_rnpv / n[0]);
-            npv_ci << exp(npv_est);
-            npv_ci << exp(npv_est - z * npv_std_err);
-            npv_ci << exp(npv_est + z * npv_std_err);
-            row_npv_ci.append(Entry(CI, npv_ci));
+            for (int r=0; r<n_rows; r++)
+            {
+                int c = jackknife::cell(bits.at(r, i), bits.at(r, j), bits.at(r, gc));
+                
+                score[r] = qMax(score.at(r), scores[c]);
+            }
         }
         
-        out_ppv_pv->appendRow(row_ppv_pv);
-        out_npv_pv->appendRow(row_npv_pv);
-        out_ppv_ci->appendRow(row_ppv_ci);
-        out_npv_ci->appendRow(row_npv_ci);
+        publish();
+        
+        if (isCancelled())
+        {
+            return;
+        }
     }
-}
-
-void Calculator::pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTable *out_lrp_pv, ResultsTable *out_lrn_pv, ResultsTable *out_lrp_ci, ResultsTable *out_lrn_ci)
-{
-    int n_rows = data->rowCount();
-    int n_cols = data->columnCount();
     
-    int gc = params->getGoldStandard();
-    
-    double q = 1.0 - (params->getPvalue() / 2.0);
-    
-    out_lrp_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
-    out_lrn_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
-    
-    boost::math::normal normal;
+    QVector<int> top = influentialRows(score, out_influence_pc);
     
-    double z = boost::math::quantile(normal, q);
+    // columns of pairs in order of Results
+    int col = 0;
     
     for (int i=0; i<n_cols; i++)
     {
@@ -516,68 +476,425 @@ void Calculator::pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTa
             continue;
         }
         
-        EntryList row_lrp_pv;
-        EntryList row_lrn_pv;
-        EntryList row_lrp_ci;
-        EntryList row_lrn_ci;
-        
-        for (int j=0; j<n_cols; j++)
+        for (int j=i+1; j<n_cols; j++)
         {
             if (j==gc)
             {
                 continue;
             }
             
-            if (i==j)
+            double n[8];
+            double values[8];
+            
+            for (int c=0; c<8; c++)
             {
-                row_lrp_pv.append(Entry());
-                row_lrn_pv.append(Entry());
-                row_lrp_ci.append(Entry());
-                row_lrn_ci.append(Entry());
-                continue;
+                n[c] = pair_counts.at(col * 8 + c);
             }
             
-            QVector<double> n(9, 0.0);
+            jackknife::leaveOneOutDifference(id, n, values);
+            
+            double difference = jackknife::difference(id, n);
             
-            for (int k=0; k<n_rows; k++)
+            for (int t=0; t<top.size(); t++)
             {
-                QStringList row = data->row(k);
+                int r = top.at(t);
+                int c = jackknife::cell(bits.at(r, i), bits.at(r, j), bits.at(r, gc));
                 
-                QString row_symbol;
-                row_symbol = "9" + row.at(gc) + row.at(i) + row.at(j);
-                
-                switch (row_symbol.toInt())
-                {
-                case 9011:
-                    n[1]++;
-                    break;
-                case 9010:
-                    n[2]++;
-                    break;
-                case 9001:
-                    n[3]++;
-                    break;
-                case 9000:
-                    n[4]++;
-                    break;
-                case 9111:
-                    n[5]++;
-                    break;
-                case 9110:
-                    n[6]++;
-                    break;
-                case 9101:
-                    n[7]++;
-                    break;
-                case 9100:
-                    n[8]++;
-                }
+                out_influence_pc->set(t, col, NUM, (n_rows - 1) * (difference - values[c]));
             }
-                
-            for (int l=1; l<9; l++)
-            {
-                if (n[l]<0.5)
-                {
+            
+            col++;
+        }
+    }
+    
+    out_influence_pc->info[0] = "Measure     = " + HEADER[id];
+    out_influence_pc->info[1] = "Ranked by   = |influence| / SE of difference";
+}
+
+QVector<int> Calculator::influentialRows(const QVector<double> &score, ResultsTable *out)
+{
+    int n_rows = score.size();
+    
+    QVector<int> order(n_rows);
+    for (int r=0; r<n_rows; r++)
+    {
+        order[r] = r;
+    }
+    
+    int top = qMin(params->getInfluentialRows(), n_rows);
+    
+    std::partial_sort(order.begin(), order.begin() + top, order.end(), jackknife::ScoreGreaterThan(score.constData()));
+    
+    order.resize(top);
+    
+    QStringList header;
+    
+    for (int t=0; t<top; t++)
+    {
+        int r = order.at(t);
+        
+        header << "row " + QString::number((row_numbers.size()==n_rows ? row_numbers.at(r) : r) + 1);
+    }
+    
+    out->setVerticalHeader(header);
+    
+    return order;
+}
+
+void Calculator::pairwiseComparision(int x, const BinaryData *input, ResultsTable *out_pv, ResultsTable *out_ci)
+{
+    int gc = params->getGoldStandard();
+    
+    int n_rows = counts ? counts->comparisonRowCount(x, gc) : input->rowCount();
+    int n_cols = bits.columnCount();
+    
+    int m = n_cols - 1;
+    
+    double q = 1.0 - (params->getPvalue() / 2.0);
+    
+    boost::math::normal normal;
+    boost::math::chi_squared chisq1(1);
+    
+    double z = boost::math::quantile(normal, q);
+    
+    QVector<int> row_sums = counts ? counts->comparisonRowSums(x, gc) : input->rowSums(gc);
+    QVector<double> col_sums(n_cols, 0.0);
+    
+    double sum = 0.0;
+    
+    for (int j=0; j<n_cols; j++)
+    {
+        if (j==gc)
+        {
+            continue;
+        }
+        
+        col_sums[j] = counts ? counts->comparisonCount(x, gc, j) : input->count(j);
+        
+        sum += col_sums[j];
+    }
+        
+    if (m>2)
+    {
+        double cochran_Q;
+        
+        boost::math::chi_squared chisq2(m-1);
+        
+        double row_sum_square = 0.0;
+        double col_sum_square = 0.0;
+        
+        for (int i=0; i<n_rows; i++)
+        {
+            row_sum_square += (double)row_sums[i] * row_sums[i];
+        }
+        
+        for (int j=0; j<n_cols; j++)
+        {
+            col_sum_square += col_sums[j] * col_sums[j];
+        }
+        
+        double denom = (m - 1) * (m * col_sum_square - sum * sum);
+        if (denom==0)
+        {
+            cochran_Q = 0.0;
+        }
+        else
+        {
+            cochran_Q = denom / (m * sum - row_sum_square);
+        }
+        
+        out_pv->info[0] = "Cochran's Q = " + QString::number(cochran_Q, 'f', 2);
+        
+        if (params->getPairwiseTest()==PERMUTATION && params->getPermutations()>0)
+        {
+            permutationtest::result mc = permutationtest::cochranQ(row_sums, m, col_sum_square, params->getPvalue(), params->getPermutations());
+            
+            out_pv->info[1] = "MC p-value  = " + QString::number(mc.pvalue, 'f', 4);
+            out_pv->info[2] = "Resamples   = " + QString::number(mc.permutations);
+        }
+        else
+        {
+            double pvalue = 1.0 - boost::math::cdf(chisq2, cochran_Q);
+            
+            out_pv->info[1] = "p-value     = " + QString::number(pvalue, 'f', 4);
+        }
+    }
+
+    out_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    
+    // with a reference test only comparisons with it are calculated, in one column
+    int reference = results->getReference();
+    int j_first = reference>=0 ? reference : 0;
+    int j_last = reference>=0 ? reference + 1 : n_cols;
+    
+    for (int i=0; i<n_cols; i++)
+    {
+        if (i==gc)
+        {
+            continue;
+        }
+        
+               
+        for (int j=j_first; j<j_last; j++)
+        {
+            if (j==gc)
+            {
+                continue;
+            }
+            
+            if (i==j)
+            {
+                continue;
+            }
+            
+            double a = counts ? counts->comparisonCountBoth(x, gc, i, j) : input->countBoth(i, j);
+            double b = col_sums[j] - a;
+            double c = col_sums[i] - a;
+            double d = n_rows - a - b - c;
+            
+            double n = a + b + c + d;
+            
+            double mc;
+            
+            if (b+c<1.0)
+            {
+                mc = 0.0;
+            }
+            else
+            {
+                mc = (abs(b - c) - 1.0);
+                mc = mc * mc / (b + c);
+            }
+            
+            double pval;
+            if (params->getPairwiseTest()==PERMUTATION)
+            {
+                pval = permutationtest::mcnemar(b, c);
+            }
+            else
+            {
+                pval = 1.0 - boost::math::cdf(chisq1, mc);
+            }
+            
+            int ir = i<gc ? i : i-1;
+            int jr = j<gc ? j : j-1;
+            int jc = reference>=0 ? 0 : jr;
+            
+            out_pv->set(ir, jc, PV, pval);
+            
+            double p1 = col_sums[i] / n_rows;
+            double p2 = col_sums[j] / n_rows;
+            
+            double std_err = sqrt(b + c - (b - c) * (b - c) / n) / n;
+
+            double est = p1 - p2;
+
+            double low = est - z * std_err - 1.0 / n;
+            if (low<-1.0)
+            {
+                low = -1.0;
+            }
+
+            double upp = est + z * std_err + 1.0 / n;
+            if (upp>1.0)
+            {
+                upp = 1.0;
+            }
+
+            out_ci->set(ir, jc, CI, est, low, upp);
+        }
+        
+        publish();
+        
+        if (isCancelled())
+        {
+            return;
+        }
+    }
+}
+
+void Calculator::pairwisePredictiveValue(const ResultsTable *ci_table, ResultsTable *out_ppv_pv, ResultsTable *out_npv_pv, ResultsTable *out_ppv_ci, ResultsTable *out_npv_ci)
+{
+    int n_cols = bits.columnCount();
+    
+    int gc = params->getGoldStandard();
+    
+    BinaryData positives;
+    BinaryData negatives;
+    
+    // rows are not selected when counts are shared
+    if (counts==NULL)
+    {
+        positives = bits.select(gc, true);
+        negatives = bits.select(gc, false);
+    }
+    
+    double q = 1.0 - (params->getPvalue() / 2.0);
+    
+    out_ppv_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    out_npv_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    
+    boost::math::normal normal;
+    
+    double z = boost::math::quantile(normal, q);
+    
+    // with a reference test only comparisons with it are calculated, in one column
+    int reference = results->getReference();
+    int j_first = reference>=0 ? reference : 0;
+    int j_last = reference>=0 ? reference + 1 : n_cols;
+    
+    for (int i=0; i<n_cols; i++)
+    {
+        if (i==gc)
+        {
+            continue;
+        }
+        
+        
+        for (int j=j_first; j<j_last; j++)
+        {
+            if (j==gc)
+            {
+                continue;
+            }
+            
+            if (i==j)
+            {
+                continue;
+            }
+            
+            QVector<double> n(9, 0.0);
+            QVector<double> p(9, 0.0);
+            
+            crossTabulate(&negatives, false, i, j, &n[1]);
+            crossTabulate(&positives, true, i, j, &n[5]);
+            
+            for (int l=1; l<9; l++)
+            {
+                if (n[l]<0.5)
+                {
+                    n[l] = 0.1;
+                }
+                
+                n[0] += n[l];
+            }
+            
+            for (int l=1; l<9; l++)
+            {                   
+                p[l] = n[l] / n[0];
+            }
+            
+            int ir = i<gc ? i : i-1;
+            int jr = j<gc ? j : j-1;
+            int jc = reference>=0 ? 0 : jr;
+            
+            double ppvi = ci_table->value(ir, PPV);
+            double npvi = ci_table->value(ir, NPV);
+            double ppvj = ci_table->value(jr, PPV);
+            double npvj = ci_table->value(jr, NPV);
+            
+            double rppv = ppvi / ppvj;
+            double rnpv = npvi / npvj;
+            
+            double sigma2_log_rppv
+                    = 1.0 / ((p[5] + p[7]) * (p[5] + p[6]))
+                    * (p[6] * (1.0 - ppvj)
+                       + p[5] * (ppvj - ppvi)
+                       + 2.0 * (p[7] + p[3]) * ppvi * ppvj
+                       + p[7] * (1.0 - 3.0 * ppvi));
+            
+            double sigma2_log_rnpv
+                    = (npvj * (p[4] - p[3] - 2.0 * (p[4] + p[8]) * npvi) + p[2] + p[3] - npvi * (p[2] - p[4])) / ((p[2] + p[4]) * (p[3] + p[4]));
+            
+            double ppvu = log(rppv) / sqrt(sigma2_log_rppv / n[0]);
+            double npvu = log(rnpv) / sqrt(sigma2_log_rnpv / n[0]);
+            
+            out_ppv_pv->set(ir, jc, PV, 2.0 * (1.0 - boost::math::cdf(normal, fabs(ppvu))));
+            out_npv_pv->set(ir, jc, PV, 2.0 * (1.0 - boost::math::cdf(normal, fabs(npvu))));
+            
+            double ppv_est = log(rppv);
+            double ppv_std_err = sqrt(sigma2_log_rppv / n[0]);
+            out_ppv_ci->set(ir, jc, CI,
+                            exp(ppv_est),
+                            exp(ppv_est - z * ppv_std_err),
+                            exp(ppv_est + z * ppv_std_err));
+            
+            double npv_est = log(rnpv);
+            double npv_std_err = sqrt(sigma2_log_rnpv / n[0]);
+            out_npv_ci->set(ir, jc, CI,
+                            exp(npv_est),
+                            exp(npv_est - z * npv_std_err),
+                            exp(npv_est + z * npv_std_err));
+        }
+        
+        publish();
+        
+        if (isCancelled())
+        {
+            return;
+        }
+    }
+}
+
+void Calculator::pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTable *out_lrp_pv, ResultsTable *out_lrn_pv, ResultsTable *out_lrp_ci, ResultsTable *out_lrn_ci)
+{
+    int n_cols = bits.columnCount();
+    
+    int gc = params->getGoldStandard();
+    
+    BinaryData positives;
+    BinaryData negatives;
+    
+    // rows are not selected when counts are shared
+    if (counts==NULL)
+    {
+        positives = bits.select(gc, true);
+        negatives = bits.select(gc, false);
+    }
+    
+    double q = 1.0 - (params->getPvalue() / 2.0);
+    
+    out_lrp_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    out_lrn_ci->info[0] = "Conf. level = " + QString::number(1.0 - params->getPvalue(), 'f', 4);
+    
+    boost::math::normal normal;
+    
+    double z = boost::math::quantile(normal, q);
+    
+    // with a reference test only comparisons with it are calculated, in one column
+    int reference = results->getReference();
+    int j_first = reference>=0 ? reference : 0;
+    int j_last = reference>=0 ? reference + 1 : n_cols;
+    
+    for (int i=0; i<n_cols; i++)
+    {
+        if (i==gc)
+        {
+            continue;
+        }
+        
+        
+        for (int j=j_first; j<j_last; j++)
+        {
+            if (j==gc)
+            {
+                continue;
+            }
+            
+            if (i==j)
+            {
+                continue;
+            }
+            
+            QVector<double> n(9, 0.0);
+            
+            crossTabulate(&negatives, false, i, j, &n[1]);
+            crossTabulate(&positives, true, i, j, &n[5]);
+            
+            for (int l=1; l<9; l++)
+            {
+                if (n[l]<0.5)
+                {
                     n[l] = 0.1;
                 }
                 
@@ -596,11 +913,12 @@ void Calculator::pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTa
             
             int ir = i<gc ? i : i-1;
             int jr = j<gc ? j : j-1;
+            int jc = reference>=0 ? 0 : jr;
             
-            double lrpi = ci_table->row(ir).at(LRP).value.at(EST);
-            double lrni = ci_table->row(ir).at(LRN).value.at(EST);
-            double lrpj = ci_table->row(jr).at(LRP).value.at(EST);
-            double lrnj = ci_table->row(jr).at(LRN).value.at(EST);
+            double lrpi = ci_table->value(ir, LRP);
+            double lrni = ci_table->value(ir, LRN);
+            double lrpj = ci_table->value(jr, LRP);
+            double lrnj = ci_table->value(jr, LRN);
             
             double rlrp = lrpi / lrpj;
             double rlrn = lrni / lrnj;
@@ -658,121 +976,483 @@ void Calculator::pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTa
             double lrpu = log(rlrp) / sqrt(vlrp);
             double lrnu = log(rlrn) / sqrt(vlrn);
             
-            QList<double> lrp_pv;
-            lrp_pv << 2.0 * (1.0 - boost::math::cdf(normal, fabs(lrpu)));
-            row_lrp_pv.append(Entry(PV, lrp_pv));
-            
-            QList<double> lrn_pv;
-            lrn_pv << 2.0 * (1.0 - boost::math::cdf(normal, fabs(lrnu)));;
-            row_lrn_pv.append(Entry(PV, lrn_pv));
+            out_lrp_pv->set(ir, jc, PV, 2.0 * (1.0 - boost::math::cdf(normal, fabs(lrpu))));
+            out_lrn_pv->set(ir, jc, PV, 2.0 * (1.0 - boost::math::cdf(normal, fabs(lrnu))));
             
-            QList<double> lrp_ci;
             double lrp_est = log(rlrp);
             double lrp_std_err = sqrt(vlrp);
-            lrp_ci << exp(lrp_est);
-            lrp_ci << exp(lrp_est - z * lrp_std_err);
-            lrp_ci << exp(lrp_est + z * lrp_std_err);
-            row_lrp_ci.append(Entry(CI, lrp_ci));
+            out_lrp_ci->set(ir, jc, CI,
+                            exp(lrp_est),
+                            exp(lrp_est - z * lrp_std_err),
+                            exp(lrp_est + z * lrp_std_err));
             
-            QList<double> lrn_ci;
             double lrn_est = log(rlrn);
             double lrn_std_err = sqrt(vlrn);
-            lrn_ci << exp(lrn_est);
-            lrn_ci << exp(lrn_est - z * lrn_std_err);
-            lrn_ci << exp(lrn_est + z * lrn_std_err);
-            row_lrn_ci.append(Entry(CI, lrn_ci));
+            out_lrn_ci->set(ir, jc, CI,
+                            exp(lrn_est),
+                            exp(lrn_est - z * lrn_std_err),
+                            exp(lrn_est + z * lrn_std_err));
         }
         
-        out_lrp_pv->appendRow(row_lrp_pv);
-        out_lrn_pv->appendRow(row_lrn_pv);
-        out_lrp_ci->appendRow(row_lrp_ci);
-        out_lrn_ci->appendRow(row_lrn_ci);
+        publish();
+        
+        if (isCancelled())
+        {
+            return;
+        }
     }
 }
 
-void Calculator::calculate()
+void Calculator::crossTabulate(const BinaryData *input, bool value, int i, int j, double *n)
 {
-    int n_rows = data->rowCount();
-    int n_cols = data->columnCount();
-    int gc = params->getGoldStandard();
+    if (counts)
+    {
+        counts->crossTabulate(params->getGoldStandard(), value, i, j, n);
+        return;
+    }
     
-    for (int i=0; i<n_cols; i++)
+    int both = input->countBoth(i, j);
+    
+    n[0] = both;
+    n[1] = input->count(i) - both;
+    n[2] = input->count(j) - both;
+    n[3] = input->rowCount() - n[0] - n[1] - n[2];
+}
+
+void Calculator::publish(int id, int rows)
+{
+    int done = steps_done.fetchAndAddOrdered(1) + 1;
+    
+    bool report = false;
+    bool ready = false;
+    
+    // stages running at the same time share the timer, rows have their own one
     {
-        if (i==gc)
+        QMutexLocker locker(&publish_lock);
+        
+        if (publish_timer.elapsed()>=PUBLISH_INTERVAL)
         {
-            continue;
+            publish_timer.restart();
+            report = true;
         }
         
-        results->confidence_intervals->appendRow(confidenceIntervals(i));
+        if (id>=0 && streaming && rows_timer.elapsed()>=PUBLISH_INTERVAL)
+        {
+            rows_timer.restart();
+            ready = true;
+        }
     }
     
-    results->confidence_intervals->info[0] = "Conf. level = " + QString::number(params->getConfidenceLevel(), 'f', 4);
+    // entries of rows are written already, the queued signal is delivered after them
+    if (ready)
+    {
+        emit rowsReady(id, rows);
+    }
+    
+    if (report)
+    {
+        emit progress(qMin(done, steps_total), steps_total);
+    }
+}
+
+void Calculator::calculatePairwise(int x)
+{
+    if (bits.columnCount()<=2 || !results->toCalculate(x) || results->isPairwiseCalculated(x))
+    {
+        return;
+    }
     
-    if (n_cols>2)
+    switch (x)
     {
-        QList<QStringList> acc;
-        QList<QStringList> sen;
-        QList<QStringList> spe;
+    case ACC:
+    case SEN:
+    case SPE:
+        if (counts)
+        {
+            pairwiseComparision(x, NULL, results->pc_pv[x], results->pc_ci[x]);
+        }
+        else
+        {
+            BinaryData input = comparisonData(x);
+            pairwiseComparision(x, &input, results->pc_pv[x], results->pc_ci[x]);
+        }
+        break;
+    case PPV:
+    case NPV:
+        pairwisePredictiveValue(results->confidence_intervals, results->pc_pv[PPV], results->pc_pv[NPV], results->pc_ci[PPV], results->pc_ci[NPV]);
         
-        for (int i=0; i<n_rows; i++)
+        if (isCancelled())
         {
-            if (!data->isActive(i))
-            {
-                continue;
-            }
-            
-            acc.append(QStringList());
-            
-            QStringList row = data->row(i);
-            
-            if (row.at(gc)=="1")
-            {
-                sen.append(row);
-            }
-            else
+            return;
+        }
+        
+        results->setPairwiseCalculated(PPV);
+        results->setPairwiseCalculated(NPV);
+        break;
+    case LRP:
+    case LRN:
+        pairwiseLikelihoodRatio(results->confidence_intervals, results->pc_pv[LRP], results->pc_pv[LRN], results->pc_ci[LRP], results->pc_ci[LRN]);
+        
+        if (isCancelled())
+        {
+            return;
+        }
+        
+        results->setPairwiseCalculated(LRP);
+        results->setPairwiseCalculated(LRN);
+        break;
+    }
+    
+    // tables of cancelled calculation are incomplete
+    if (isCancelled())
+    {
+        return;
+    }
+    
+    results->setPairwiseCalculated(x);
+}
+
+BinaryData Calculator::comparisonData(int x) const
+{
+    int gc = params->getGoldStandard();
+    
+    switch (x)
+    {
+    case SEN:
+        return bits.select(gc, true);
+    case SPE:
+        return bits.select(gc, false).inverted();
+    default:
+        return bits.agreement(gc);
+    }
+}
+
+QVector<topk::Pair> Calculator::topPairs(int x, int k, int key) const
+{
+    BinaryData input = comparisonData(x);
+    
+    return topk::query(&input, params->getGoldStandard(), k, key, params->getPairwiseTest()==PERMUTATION);
+}
+
+bool Calculator::isCalculated(int id) const
+{
+    if (results==NULL || !results->areCalculated())
+    {
+        return false;
+    }
+    
+    // only pairwise tables are calculated later, see setLazy()
+    if (id<1 || id>=NRESTOT || bits.columnCount()<=2 || !results->toCalculate((id - 1) / 2))
+    {
+        return true;
+    }
+    
+    return results->isPairwiseCalculated((id - 1) / 2);
+}
+
+void Calculator::calculateTable(int id)
+{
+    if (results==NULL || !results->areCalculated())
+    {
+        return;
+    }
+    
+    cancelled = 0;
+    
+    calculatePairwiseTables(preparePairwise(QList<int>() << id));
+}
+
+QFuture<void> Calculator::startTables(const QList<int> &ids)
+{
+    QList<int> measures;
+    
+    cancelled = 0;
+    
+    // tables are sized here, in the thread of their views
+    if (results!=NULL && results->areCalculated())
+    {
+        measures = preparePairwise(ids);
+    }
+    
+    return QtConcurrent::run(this, &Calculator::calculatePairwiseTables, measures);
+}
+
+void Calculator::calculatePairwiseTables(const QList<int> &measures)
+{
+    publish_timer.start();
+    
+    steps_done = 0;
+    steps_total = measures.size() * (bits.columnCount() - 1);
+    
+    // measures are independent, each is calculated in its own thread as in calculateAll()
+    QList<QFuture<void> > stages;
+    
+    for (int k=0; k<measures.size(); k++)
+    {
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, measures.at(k));
+    }
+    
+    for (int k=0; k<stages.size(); k++)
+    {
+        stages[k].waitForFinished();
+    }
+    
+    if (isCancelled() || measures.isEmpty())
+    {
+        return;
+    }
+    
+    results->adjustPvalues();
+    
+    emit progress(steps_total, steps_total);
+}
+
+void Calculator::calculate()
+{
+    calculate(BinaryData::fromDataTable(data));
+}
+
+void Calculator::calculate(const BinaryData &input)
+{
+    params = source;
+    bits = input;
+    cancelled = 0;
+    
+    prepareTables();
+    calculateAll();
+}
+
+QFuture<void> Calculator::start()
+{
+    // data and params may change while calculating, so copies are used
+    snapshot.assign(source);
+    params = &snapshot;
+    bits = BinaryData::fromDataTable(data);
+    cancelled = 0;
+    
+    // views may show the table while it is written, see rowsReady()
+    prepareTables();
+    
+    if (streaming)
+    {
+        results->confidence_intervals->hideRows();
+    }
+    
+    return QtConcurrent::run(this, &Calculator::calculateAll);
+}
+
+void Calculator::prepareTables()
+{
+    int n_cols = bits.columnCount();
+    
+    // influential rows are labelled by their numbers in input file, stages do not read data
+    row_numbers.clear();
+    
+    if (data!=NULL)
+    {
+        for (int r=0; r<data->rowCount(); r++)
+        {
+            if (data->isActive(r))
             {
-                spe.append(QStringList());
-                for (int j=0; j<n_cols; j++)
-                {
-                    if (row.at(j)=="1")
-                    {
-                        spe.last().append("0");
-                    }
-                    else
-                    {
-                        spe.last().append("1");
-                    }
-                }
+                row_numbers.append(r);
             }
-            
-            for (int j=0; j<n_cols; j++)
+        }
+    }
+    
+    results->confidence_intervals->setRowCount(n_cols - 1);
+    results->confidence_intervals->info[0] = "Conf. level = " + QString::number(params->getConfidenceLevel(), 'f', 4);
+    
+    if (results->hasTable(PREVALENCE_PPV))
+    {
+        QVector<double> grid = params->getPrevalenceGrid();
+        QStringList header;
+        
+        for (int k=0; k<grid.size(); k++)
+        {
+            header << QString::number(grid.at(k));
+        }
+        
+        results->prevalence_ppv->setHorizontalHeader(header);
+        results->prevalence_npv->setHorizontalHeader(header);
+        
+        results->prevalence_ppv->setRowCount(n_cols - 1);
+        results->prevalence_npv->setRowCount(n_cols - 1);
+    }
+    
+    if (results->hasTable(JACKKNIFE_SE))
+    {
+        int top = qMin(params->getInfluentialRows(), bits.rowCount());
+        
+        results->jackknife_se->setRowCount(n_cols - 1);
+        
+        for (int k=0; k<NRESULTS; k++)
+        {
+            if (results->toCalculate(k))
             {
-                if (row.at(gc)==row.at(j))
-                {
-                    acc.last().append("1");
-                }
-                else
-                {
-                    acc.last().append("0");
-                }
+                results->influence[k]->setRowCount(top);
             }
         }
         
-        if (results->toCalculate(ACC))
-            pairwiseComparision(&acc, results->pc_pv[ACC], results->pc_ci[ACC]);
-        if (results->toCalculate(SEN))
-            pairwiseComparision(&sen, results->pc_pv[SEN], results->pc_ci[SEN]);
-        if (results->toCalculate(SPE))
-            pairwiseComparision(&spe, results->pc_pv[SPE], results->pc_ci[SPE]);
+        if (results->toCalculate(params->getJackknifeMeasure()) && n_cols>2)
+        {
+            results->jackknife_pc->setRowCount(n_cols - 1);
+            results->influence_pc->setRowCount(top);
+        }
+    }
+    
+    if (!lazy)
+    {
+        QList<int> ids;
+        
+        for (int id=1; id<NRESTOT; id++)
+        {
+            ids << id;
+        }
+        
+        preparePairwise(ids);
+    }
+}
+
+QList<int> Calculator::preparePairwise(const QList<int> &ids)
+{
+    QList<int> measures;
+    
+    for (int k=0; k<ids.size(); k++)
+    {
+        if (ids.at(k)<1 || ids.at(k)>=NRESTOT || bits.columnCount()<=2)
+        {
+            continue;
+        }
+        
+        // predictive values and likelihood ratios are calculated in pairs
+        int x = (ids.at(k) - 1) / 2;
+        int first = (x==NPV || x==LRN) ? x - 1 : x;
+        int last = (first==PPV || first==LRP) ? first + 1 : first;
+        
+        if (!results->toCalculate(x) || results->isPairwiseCalculated(x) || measures.contains(first))
+        {
+            continue;
+        }
+        
+        measures << first;
+        
+        for (int y=first; y<=last; y++)
+        {
+            results->pc_pv[y]->setRowCount(bits.columnCount() - 1);
+            results->pc_ci[y]->setRowCount(bits.columnCount() - 1);
+        }
+    }
+    
+    return measures;
+}
+
+void Calculator::cancel()
+{
+    cancelled = 1;
+}
+
+int Calculator::pairwisePasses() const
+{
+    int passes = 0;
+    
+    for (int x=0; x<NRESULTS; x++)
+    {
+        // predictive values and likelihood ratios are calculated in pairs
+        if (results->toCalculate(x) && !((x==NPV && results->toCalculate(PPV)) || (x==LRN && results->toCalculate(LRP))))
+        {
+            passes++;
+        }
+    }
+    
+    return passes;
+}
+
+void Calculator::calculateAll()
+{
+    publish_timer.start();
+    rows_timer.start();
+    
+    int n_cols = bits.columnCount();
+    int gc = params->getGoldStandard();
+    
+    // one step is one row of a table
+    steps_done = 0;
+    steps_total = n_cols - 1;
+    
+    if (results->hasTable(JACKKNIFE_SE))
+    {
+        // standard errors and influence of pairwise differences
+        steps_total += 2 * (n_cols - 1);
+    }
+    
+    if (n_cols>2 && !lazy)
+    {
+        steps_total += pairwisePasses() * (n_cols - 1);
+    }
+    
+    /*
+      stages form a graph: only comparisons of predictive values and
+      likelihood ratios need the CI table, so all other stages run in the
+      pool next to it and they start as soon as it is done
+    */
+    bool pairwise = n_cols>2 && !lazy;
+    
+    QList<QFuture<void> > stages;
+    
+    if (results->hasTable(PREVALENCE_PPV))
+    {
+        stages << QtConcurrent::run(this, &Calculator::prevalenceSweep, results->prevalence_ppv, results->prevalence_npv);
+    }
+    
+    if (results->hasTable(JACKKNIFE_SE))
+    {
+        stages << QtConcurrent::run(this, &Calculator::jackknifeStatistics, results->jackknife_se, results->jackknife_pc, &results->influence[0], results->influence_pc);
+    }
+    
+    if (pairwise)
+    {
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, ACC);
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, SEN);
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, SPE);
+    }
+    
+    for (int i=0; i<n_cols && !isCancelled(); i++)
+    {
+        if (i==gc)
+        {
+            continue;
+        }
+        
+        confidenceIntervals(i, i<gc ? i : i-1, results->confidence_intervals);
         
-        if (results->toCalculate(PPV) || results->toCalculate(NPV))
-            pairwisePredictiveValue(results->confidence_intervals, results->pc_pv[PPV], results->pc_pv[NPV], results->pc_ci[PPV], results->pc_ci[NPV]);
-        if (results->toCalculate(LRP) || results->toCalculate(LRN))
-            pairwiseLikelihoodRatio(results->confidence_intervals, results->pc_pv[LRP], results->pc_pv[LRN], results->pc_ci[LRP], results->pc_ci[LRN]);
+        publish(0, i<gc ? i + 1 : i);
+    }
+    
+    if (pairwise && !isCancelled())
+    {
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, PPV);
+        stages << QtConcurrent::run(this, &Calculator::calculatePairwise, LRP);
+    }
+    
+    // stages are waited for even if cancelled, they use tables of results
+    for (int k=0; k<stages.size(); k++)
+    {
+        stages[k].waitForFinished();
+    }
+    
+    if (isCancelled())
+    {
+        return;
     }
     
+    if (pairwise)
+    {
+        results->adjustPvalues();
+    }
+    
+    emit progress(steps_total, steps_total);
+    
     results->setCalculated(true);
-    results->buildHighlightTables();
     
     emit calculated(true);
 }
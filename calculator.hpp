@@ -20,7 +20,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CALCULATOR_HPP
 
 #include <QObject>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QMutex>
 #include <QVector>
+#include <QTime>
 
 #include <boost/math/distributions/fisher_f.hpp>
 #include <boost/math/distributions/normal.hpp>
@@ -28,8 +32,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "params.hpp"
 #include "datatable.hpp"
+#include "binarydata.hpp"
+#include "cooccurrence.hpp"
 #include "results.hpp"
 #include "resultstable.hpp"
+#include "permutationtest.hpp"
+#include "jackknife.hpp"
+#include "topk.hpp"
+
+//! minimal time (ms) between updates of views while calculating
+const int PUBLISH_INTERVAL = 200;
 
 class Calculator : public QObject
 {
@@ -37,9 +49,17 @@ class Calculator : public QObject
 public:
     explicit Calculator(DataTable *data, Results *results, Params *params, QObject *parent = 0);
     
-    Entry confidenceInterval(double y, double n);
-    EntryList confidenceIntervals(int column);
-    void pairwiseComparision(QList<QStringList> *input, ResultsTable *out_pv, ResultsTable *out_ci);
+    void confidenceInterval(double y, double n, ResultsTable *out, int row, int col);
+    void confidenceIntervals(int column, int row, ResultsTable *out);
+    
+    //! tables written by the stages below are sized first, see prepareTables()
+    void prevalenceSweep(ResultsTable *out_ppv, ResultsTable *out_npv);
+    //! out_influence are tables of every measure, see Results::influence
+    void jackknifeStatistics(ResultsTable *out_se, ResultsTable *out_pc, ResultsTable **out_influence, ResultsTable *out_influence_pc);
+    
+    //! input is data compared for measure x (see comparisonData()), it is not used with shared counts
+    void pairwiseComparision(int x, const BinaryData *input, ResultsTable *out_pv, ResultsTable *out_ci);
+    
     void pairwisePredictiveValue(const ResultsTable *ci_table, ResultsTable *out_ppv_pv, ResultsTable *out_npv_pv, ResultsTable *out_ppv_ci, ResultsTable *out_npv_ci);
     void pairwiseLikelihoodRatio(const ResultsTable *ci_table, ResultsTable *out_lrp_pv, ResultsTable *out_lrn_pv, ResultsTable *out_lrp_ci, ResultsTable *out_lrn_ci);
     
@@ -53,16 +73,167 @@ public:
         this->results = results;
     }
     
+    /*!
+      cross-tabulations are read from counts of the same packed data instead
+      of counting rows, so they are shared by calculations of every gold
+      standard; NULL counts rows again
+    */
+    void setCooccurrence(const Cooccurrence *counts)
+    {
+        this->counts = counts;
+    }
+    
+    /*!
+      shows rows of tables in views as soon as they are calculated:
+      rowsReady() is emitted for the table of confidence intervals while
+      it is calculated in another thread, see start()
+    */
+    void setStreaming(bool streaming)
+    {
+        this->streaming = streaming;
+    }
+    
+    /*!
+      pairwise tables are not calculated by calculate() or start(), but the
+      first time they are asked for by calculateTable() or startTables()
+    */
+    void setLazy(bool lazy)
+    {
+        this->lazy = lazy;
+    }
+    
+    //! is table with given id (see Results::table()) of calculated results calculated too
+    bool isCalculated(int id) const;
+    
+    //! calculates table with given id (see Results::table()) unless it is already calculated
+    void calculateTable(int id);
+    
+    /*!
+      calculates tables with given ids which are not calculated yet in
+      another thread, like start() with its copies of data and params;
+      progress() is emitted while calculating, see cancel()
+    */
+    QFuture<void> startTables(const QList<int> &ids);
+    
+    /*!
+      returns k pairs of tests with smallest p-values or largest differences
+      (key, see topk::query()) of measure x (ACC, SEN or SPE) of the last
+      calculated data, pairwise tables are not needed
+    */
+    QVector<topk::Pair> topPairs(int x, int k, int key) const;
+    
+    /*!
+      calculates results of data in another thread, on copies of data and
+      params made now (later calculateTable() uses them too); progress() is
+      emitted while calculating, see cancel()
+    */
+    QFuture<void> start();
+    
 signals:
     void calculated(bool);
+    
+    //! done of total steps (rows of tables) are calculated
+    void progress(int done, int total);
+    
+    /*!
+      rows of table id (see Results::table()) before rows are calculated by
+      another thread and may be shown, see setStreaming() and
+      ResultsTable::showRows()
+    */
+    void rowsReady(int id, int rows);
 
 public slots:
     void calculate();
+    
+    //! stops calculation as soon as the current row is done, results are not calculated then
+    void cancel();
+
+public:
+    //! was the last calculation cancelled
+    bool isCancelled() const
+    {
+        return cancelled==1;
+    }
+    
+    //! calculates results for already packed data
+    void calculate(const BinaryData &input);
 
 private:
+    /*!
+      counts rows with (1,1), (1,0), (0,1) and (0,0) in columns i and j
+      among rows with value in gold standard, input are these rows (it is
+      not used with shared counts)
+    */
+    void crossTabulate(const BinaryData *input, bool value, int i, int j, double *n);
+    
+    //! returns data compared by McNemar test for measure x (ACC, SEN or SPE)
+    BinaryData comparisonData(int x) const;
+    
+    //! calculates pairwise tables of measure x (and of its pair for predictive values and likelihood ratios)
+    void calculatePairwise(int x);
+    
+    //! calculates pairwise tables of measures sized by preparePairwise() and adjusts their p-values
+    void calculatePairwiseTables(const QList<int> &measures);
+    
+    //! calculates all tables of packed data bits
+    void calculateAll();
+    
+    /*!
+      returns most influential rows by descending score, their numbers in
+      input file are set as vertical header of table out
+    */
+    QVector<int> influentialRows(const QVector<double> &score, ResultsTable *out);
+    
+    //! returns number of passes over rows for pairwise tables
+    int pairwisePasses() const;
+    
+    /*!
+      sizes all tables written by stages and takes numbers of rows of data
+      before calculation starts, so stages running in other threads do not
+      reset models of views nor read data
+    */
+    void prepareTables();
+    
+    /*!
+      sizes pairwise tables with given ids (see Results::table()) which are
+      not calculated yet, returns measures to pass to calculatePairwise()
+    */
+    QList<int> preparePairwise(const QList<int> &ids);
+    
+    /*!
+      counts step, emits progress() if PUBLISH_INTERVAL passed since last
+      time; rows of table id are done, rowsReady() is emitted for them
+      (streaming only)
+    */
+    void publish(int id = -1, int rows = 0);
+    
     DataTable *data;
+    
+    //! packed data of current calculation
+    BinaryData bits;
+    
+    //! numbers of rows of bits in input file, see prepareTables()
+    QVector<int> row_numbers;
+    
+    //! shared counts of bits or NULL, see setCooccurrence()
+    const Cooccurrence *counts;
+    
     Results *results;
+    
+    //! params of current calculation, source or its snapshot
     Params *params;
+    Params *source;
+    Params snapshot;
+    
+    QAtomicInt cancelled;
+    QAtomicInt steps_done;
+    int steps_total;
+    
+    bool streaming;
+    bool lazy;
+    QTime publish_timer;
+    QTime rows_timer;
+    QMutex publish_lock;
 
 };
 
@@ -0,0 +1,864 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cli.hpp"
+#include "params.hpp"
+#include "datatable.hpp"
+#include "results.hpp"
+#include "calculator.hpp"
+#include "exporter.hpp"
+#include "strata.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cstdio>
+
+namespace
+{
+    //! options of batch mode, all but -h take a value
+    const QStringList OPTIONS = (QStringList() << "-h" << "--help" << "-o" << "-d" << "-s" << "-g" << "-c" << "-p" << "-m" << "-b" << "-k" << "-j" << "-M");
+
+    void print(const QString &message)
+    {
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+
+    //! returns column of name or number (from 1) or -1
+    int findColumn(const QStringList &header, const QString &column)
+    {
+        bool ok;
+        int number = column.toInt(&ok);
+
+        if (ok)
+        {
+            return number>=1 && number<=header.length() ? number - 1 : -1;
+        }
+
+        return header.indexOf(column);
+    }
+
+    //! options of calculation, the same for all input files
+    struct Options
+    {
+        QString gold;
+        double confidence;
+        double pvalue;
+        int measures;
+        QStringList strata;
+        //! number of pairs of tests saved instead of pairwise tables or 0
+        int top;
+    };
+
+    //! one row of index of batch
+    struct Summary
+    {
+        QString input;
+        QString output;
+        int rows;
+        int columns;
+        QString status;
+    };
+
+    /*!
+      returns requested measures (see Params::getCaseToCalculate()) unless
+      gold standard gc of bits allows only sensitivity or specificity
+    */
+    int measuresToCalculate(const BinaryData &bits, int gc, int requested)
+    {
+        int possible = Results::caseToCalculate(bits, gc);
+
+        return possible==ALL ? requested : possible;
+    }
+
+    /*!
+      returns table of k pairs of tests with smallest p-values of measure x
+      (ACC, SEN or SPE) of the last calculation of calculator, see
+      Calculator::topPairs(); header holds names of all columns of data
+    */
+    ResultsTable *topPairs(const Calculator &calculator, int x, int k, const QStringList &header, Permutation *order)
+    {
+        QVector<topk::Pair> pairs = calculator.topPairs(x, k, SMALLEST_PVALUE);
+
+        QStringList names;
+
+        for (int p=0; p<pairs.size(); p++)
+        {
+            names << header.at(pairs.at(p).i) + " - " + header.at(pairs.at(p).j);
+        }
+
+        ResultsTable *table = new ResultsTable(order, true);
+
+        table->setHorizontalHeader(QStringList() << "Difference" << "p-value");
+        table->setVerticalHeader(names);
+        table->setRowCount(pairs.size());
+
+        for (int p=0; p<pairs.size(); p++)
+        {
+            table->set(p, 0, NUM, pairs.at(p).difference);
+            table->set(p, 1, NUM, pairs.at(p).pvalue);
+        }
+
+        table->info[0] = "Measure     = " + HEADER[x];
+        table->info[1] = "Ranked by   = p-value of McNemar test";
+
+        return table;
+    }
+
+    //! is output saved as text (not long format or columnar binary file)
+    bool isText(const QString &output)
+    {
+        QString name = output;
+
+        if (exporter::isCompressed(name))
+        {
+            name.chop(3);
+        }
+
+        return !name.endsWith(".bdtc") && !name.endsWith(".tsv");
+    }
+
+    /*!
+      calculates results of every column as the gold standard in turn and
+      saves them one after another to text file output; packed data and
+      counts of its pairs and triples of columns are shared by all of them
+      (rows are counted by every calculation if the counts do not fit in the
+      memory budget)
+    */
+    int sweep(DataTable *data, Params *params, const QString &output, QString *error)
+    {
+        if (!isText(output))
+        {
+            *error = "Results of all gold standards are saved as text only.";
+            return 2;
+        }
+
+        BinaryData bits = BinaryData::fromDataTable(data);
+        Cooccurrence *counts = NULL;
+
+        if (Cooccurrence::fits(bits.columnCount(), params->getMemoryBudget()))
+        {
+            counts = new Cooccurrence(bits);
+        }
+
+        int code = 0;
+
+        QStringList header = data->getHeader();
+        int requested = params->getCaseToCalculate();
+
+        for (int gc=0; gc<header.length() && code==0; gc++)
+        {
+            params->setGoldStandard(gc);
+            params->setCaseToCalculate(measuresToCalculate(bits, gc, requested));
+
+            Results results(data, params);
+            Calculator calculator(data, &results, params);
+
+            calculator.setCooccurrence(counts);
+            calculator.calculate(bits);
+
+            QList<exporter::Table> tables = exporter::tables(&results);
+
+            for (int t=0; t<tables.length(); t++)
+            {
+                tables[t].name = "Gold standard " + header.at(gc) + ": " + tables.at(t).name;
+            }
+
+            if (!exporter::save(output, tables, gc>0))
+            {
+                *error = "Results could not be saved to " + output + ".";
+                code = 1;
+            }
+        }
+
+        delete counts;
+
+        return code;
+    }
+
+    /*!
+      calculates results of every group of rows with the same values of
+      stratum columns and of all rows pooled, saves them one after another
+      to text file output; gc is the gold standard among all columns of data
+    */
+    int stratify(DataTable *data, Params *params, int gc, const QString &output, QString *error)
+    {
+        if (!isText(output))
+        {
+            *error = "Results of strata are saved as text only.";
+            return 2;
+        }
+
+        QList<int> columns = strata::columns(data);
+        QStringList header = strata::header(data);
+
+        if (header.length()<2)
+        {
+            *error = "Load at least 2 columns of data besides strata.";
+            return 1;
+        }
+
+        // the gold standard among columns of tests
+        int tests_gc = gc;
+
+        for (int s=0; s<columns.length(); s++)
+        {
+            if (columns.at(s)<gc)
+            {
+                tests_gc--;
+            }
+        }
+
+        params->setGoldStandard(tests_gc);
+
+        QList<strata::Group> groups;
+        BinaryData pooled = strata::split(data, &groups);
+
+        // counts of all rows are sums of counts of groups, which are added as soon as they are counted
+        bool shared = Cooccurrence::fits(header.length(), params->getMemoryBudget() / 2);
+        Cooccurrence *pooled_counts = shared ? new Cooccurrence(pooled, false) : NULL;
+
+        int code = 0;
+        int requested = params->getCaseToCalculate();
+
+        // all rows pooled after the last group
+        for (int g=0; g<=groups.length() && code==0; g++)
+        {
+            bool all = g==groups.length();
+            const BinaryData &bits = all ? pooled : groups.at(g).bits;
+            Cooccurrence *counts = NULL;
+
+            if (shared && !all)
+            {
+                counts = new Cooccurrence(groups.at(g).bits);
+                pooled_counts->add(*counts);
+            }
+
+            params->setCaseToCalculate(measuresToCalculate(bits, tests_gc, requested));
+
+            Results results(header, params);
+            Calculator calculator(NULL, &results, params);
+
+            calculator.setCooccurrence(all ? pooled_counts : counts);
+            calculator.calculate(bits);
+
+            delete counts;
+
+            QString name = all ? QString("All strata") : "Stratum " + groups.at(g).name;
+            QList<exporter::Table> tables = exporter::tables(&results);
+
+            for (int t=0; t<tables.length(); t++)
+            {
+                tables[t].name = name + ": " + tables.at(t).name;
+            }
+
+            if (!exporter::save(output, tables, g>0))
+            {
+                *error = "Results could not be saved to " + output + ".";
+                code = 1;
+            }
+        }
+
+        delete pooled_counts;
+
+        return code;
+    }
+
+    //! reads, calculates and saves one file, returns exit code and sets error
+    int process(const QString &input, const QString &output, const Options &options, Summary *summary, QString *error)
+    {
+        Params params;
+
+        params.setStrata(options.strata);
+        params.setConfidenceLevel(options.confidence);
+        params.setPvalue(1.0 - options.pvalue);
+        params.setThreshold(options.pvalue);
+        params.setCaseToCalculate(options.measures);
+
+        DataTable data(input, &params);
+
+        if (!data.errorString().isEmpty())
+        {
+            *error = data.errorString();
+            return 1;
+        }
+
+        if (summary)
+        {
+            summary->rows = data.rowCount();
+            summary->columns = data.columnCount();
+        }
+
+        if (data.columnCount()<2)
+        {
+            *error = "Load at least 2 columns of data.";
+            return 1;
+        }
+
+        for (int s=0; s<options.strata.length(); s++)
+        {
+            if (findColumn(data.getHeader(), options.strata.at(s))<0)
+            {
+                *error = "There is no column " + options.strata.at(s) + ".";
+                return 2;
+            }
+        }
+
+        if (options.gold=="all")
+        {
+            return sweep(&data, &params, output, error);
+        }
+
+        int gc = findColumn(data.getHeader(), options.gold);
+
+        if (gc<0)
+        {
+            *error = "There is no column " + options.gold + ".";
+            return 2;
+        }
+
+        if (!options.strata.isEmpty())
+        {
+            if (data.isStratum(gc))
+            {
+                *error = "Gold standard cannot be a stratum column.";
+                return 2;
+            }
+
+            return stratify(&data, &params, gc, output, error);
+        }
+
+        if (options.top>0 && !isText(output))
+        {
+            *error = "Top pairs of tests are saved as text only.";
+            return 2;
+        }
+
+        BinaryData bits = BinaryData::fromDataTable(&data);
+
+        params.setGoldStandard(gc);
+        params.setCaseToCalculate(measuresToCalculate(bits, gc, options.measures));
+
+        Results results(&data, &params);
+        Calculator calculator(&data, &results, &params);
+
+        // pairwise tables are left empty, so they are not saved
+        calculator.setLazy(options.top>0);
+        calculator.calculate(bits);
+
+        QString name = output;
+
+        if (exporter::isCompressed(name))
+        {
+            name.chop(3);
+        }
+
+        bool saved;
+
+        if (name.endsWith(".bdtc"))
+        {
+            saved = exporter::saveColumnar(output, &results);
+        }
+        else if (name.endsWith(".tsv"))
+        {
+            saved = exporter::saveLong(output, &results, exporter::Filter());
+        }
+        else
+        {
+            QList<exporter::Table> tables = exporter::tables(&results);
+
+            Permutation order(options.top);
+            QList<ResultsTable *> top_tables;
+
+            for (int x=0; x<=SPE && options.top>0 && data.columnCount()>2; x++)
+            {
+                if (results.toCalculate(x))
+                {
+                    top_tables << topPairs(calculator, x, options.top, data.getHeader(), &order);
+
+                    exporter::Table table;
+                    table.name = "Top " + QString::number(options.top) + " pairs of tests: " + HEADER[x];
+                    table.table = top_tables.last();
+
+                    tables << table;
+                }
+            }
+
+            saved = exporter::save(output, tables);
+
+            qDeleteAll(top_tables);
+        }
+
+        if (!saved)
+        {
+            *error = "Results could not be saved to " + output + ".";
+            return 1;
+        }
+
+        return 0;
+    }
+
+    /*!
+      Processes one file in the pool of batch. Memory of its data is taken
+      from the budget first, so large files wait until others are saved
+      (a file larger than the whole budget runs alone).
+    */
+    class Job : public QRunnable
+    {
+    public:
+        Job(const Options *options, QSemaphore *memory, int budget, Summary *summary)
+        {
+            this->options = options;
+            this->memory = memory;
+            this->budget = budget;
+            this->summary = summary;
+        }
+
+        void run()
+        {
+            qint64 size = QFileInfo(summary->input).size();
+            int cost = (int)qMin<qint64>(size * cli::MEMORY_FACTOR / (1024 * 1024) + 1, budget);
+
+            memory->acquire(cost);
+
+            QString error;
+            process(summary->input, summary->output, *options, summary, &error);
+
+            memory->release(cost);
+
+            if (error.isEmpty())
+            {
+                summary->status = "OK";
+            }
+            else
+            {
+                summary->status = error;
+                print(summary->input + ": " + error);
+            }
+        }
+
+    private:
+        const Options *options;
+        QSemaphore *memory;
+        int budget;
+        Summary *summary;
+    };
+
+    //! appends names of files of argument (wildcard or @LIST) to inputs, returns false if there are none
+    bool expand(const QString &argument, QStringList *inputs)
+    {
+        if (argument.startsWith("@"))
+        {
+            QFile list(argument.mid(1));
+
+            if (!list.open(QIODevice::ReadOnly | QIODevice::Text))
+            {
+                print("Cannot read file " + argument.mid(1) + ".");
+                return false;
+            }
+
+            QTextStream stream(&list);
+
+            while (!stream.atEnd())
+            {
+                QString line = stream.readLine().trimmed();
+
+                if (!line.isEmpty() && !expand(line, inputs))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // shells of some systems do not expand wildcards
+        if (argument!="-" && (argument.contains('*') || argument.contains('?') || argument.contains('[')))
+        {
+            QFileInfo info(argument);
+            QDir dir = info.dir();
+
+            QStringList names = dir.entryList(QStringList(info.fileName()), QDir::Files, QDir::Name);
+
+            if (names.isEmpty())
+            {
+                print("No files match " + argument + ".");
+                return false;
+            }
+
+            for (int k=0; k<names.length(); k++)
+            {
+                inputs->append(info.path()=="." ? names.at(k) : dir.filePath(names.at(k)));
+            }
+
+            return true;
+        }
+
+        inputs->append(argument);
+        return true;
+    }
+
+    //! processes inputs by jobs at the same time, writes index to directory or standard output
+    int batch(const QStringList &inputs, const Options &options, const QString &directory, const QString &suffix, int jobs, int budget)
+    {
+        if (inputs.contains("-"))
+        {
+            print("Standard input can be processed only alone.");
+            return 2;
+        }
+
+        if (!directory.isNull() && !QDir().mkpath(directory))
+        {
+            print("Cannot create directory " + directory + ".");
+            return 1;
+        }
+
+        QVector<Summary> summaries(inputs.length());
+        QStringList outputs;
+
+        for (int k=0; k<inputs.length(); k++)
+        {
+            QFileInfo info(inputs.at(k));
+            QDir dir = directory.isNull() ? info.dir() : QDir(directory);
+
+            QString output = dir.filePath(info.completeBaseName() + suffix);
+
+            // inputs of the same name from different directories
+            for (int n=2; outputs.contains(output); n++)
+            {
+                output = dir.filePath(info.completeBaseName() + "_" + QString::number(n) + suffix);
+            }
+
+            outputs << output;
+
+            summaries[k].input = inputs.at(k);
+            summaries[k].output = output;
+            summaries[k].rows = 0;
+            summaries[k].columns = 0;
+        }
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(jobs);
+
+        QSemaphore memory(budget);
+
+        for (int k=0; k<summaries.size(); k++)
+        {
+            pool.start(new Job(&options, &memory, budget, &summaries[k]));
+        }
+
+        pool.waitForDone();
+
+        QFile file;
+        bool opened;
+
+        if (directory.isNull())
+        {
+            opened = file.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+        }
+        else
+        {
+            file.setFileName(QDir(directory).filePath("index.txt"));
+            opened = file.open(QIODevice::WriteOnly | QIODevice::Text);
+        }
+
+        if (!opened)
+        {
+            print("Index could not be saved to " + file.fileName() + ".");
+            return 1;
+        }
+
+        QTextStream stream(&file);
+        int failed = 0;
+
+        stream << "Input\tOutput\tRows\tColumns\tStatus\n";
+
+        for (int k=0; k<summaries.size(); k++)
+        {
+            const Summary &summary = summaries.at(k);
+
+            stream << summary.input << '\t' << summary.output << '\t' << summary.rows << '\t' << summary.columns << '\t' << summary.status << '\n';
+
+            if (summary.status!="OK")
+            {
+                failed++;
+            }
+        }
+
+        stream.flush();
+
+        if (failed>0)
+        {
+            print(QString::number(failed) + " of " + QString::number(summaries.size()) + " files failed.");
+            return 1;
+        }
+
+        return 0;
+    }
+
+    //! returns positive number of option or 0
+    int positive(const QString &value)
+    {
+        bool ok;
+        int number = value.toInt(&ok);
+
+        return ok && number>0 ? number : 0;
+    }
+}
+
+bool cli::isBatch(const QStringList &arguments)
+{
+    for (int k=1; k<arguments.length(); k++)
+    {
+        QString argument = arguments.at(k);
+
+        if (OPTIONS.contains(argument) || argument=="-")
+        {
+            return true;
+        }
+
+        // other options belong to Qt (e.g. -style motif) or to the system (-psn_* of Mac OS X), with their values
+        if (argument.startsWith("-"))
+        {
+            if (k + 1<arguments.length() && !arguments.at(k + 1).startsWith("-"))
+            {
+                k++;
+            }
+
+            continue;
+        }
+
+        // input file
+        return true;
+    }
+
+    return false;
+}
+
+int cli::run(const QStringList &arguments)
+{
+    QStringList inputs;
+    QString output;
+    QString directory;
+    QString suffix = "_out.txt";
+    QString gold = "1";
+    QString confidence = "0.95";
+    QString pvalue = "0.05";
+    QString measures = "all";
+    QString strata;
+    int top = 0;
+    int jobs = QThread::idealThreadCount();
+    int budget = MEMORY_BUDGET;
+
+    for (int k=1; k<arguments.length(); k++)
+    {
+        QString option = arguments.at(k);
+
+        if (option=="-h" || option=="--help")
+        {
+            fprintf(stdout, "%s", qPrintable(USAGE));
+            return 0;
+        }
+
+        if (option.startsWith("-") && option!="-")
+        {
+            if (k + 1>=arguments.length())
+            {
+                print("Missing value of option " + option + ".");
+                return 2;
+            }
+
+            QString value = arguments.at(++k);
+
+            if (option=="-o")
+            {
+                output = value;
+            }
+            else if (option=="-d")
+            {
+                directory = value;
+            }
+            else if (option=="-s")
+            {
+                suffix = value;
+            }
+            else if (option=="-g")
+            {
+                gold = value;
+            }
+            else if (option=="-c")
+            {
+                confidence = value;
+            }
+            else if (option=="-p")
+            {
+                pvalue = value;
+            }
+            else if (option=="-m")
+            {
+                measures = value;
+            }
+            else if (option=="-b")
+            {
+                strata = value;
+            }
+            else if (option=="-k" || option=="-j" || option=="-M")
+            {
+                int number = positive(value);
+
+                if (number==0)
+                {
+                    print("Value of option " + option + " has to be a positive number.");
+                    return 2;
+                }
+
+                if (option=="-k")
+                {
+                    top = number;
+                }
+                else if (option=="-j")
+                {
+                    jobs = number;
+                }
+                else
+                {
+                    budget = number;
+                }
+            }
+            else
+            {
+                print("Unknown option " + option + ", see -h.");
+                return 2;
+            }
+
+            continue;
+        }
+
+        if (!expand(option, &inputs))
+        {
+            return 2;
+        }
+    }
+
+    if (inputs.isEmpty())
+    {
+        print(USAGE);
+        return 2;
+    }
+
+    Options options;
+
+    bool ok_cl;
+    bool ok_pv;
+    options.confidence = confidence.toDouble(&ok_cl);
+    options.pvalue = pvalue.toDouble(&ok_pv);
+    options.gold = gold;
+    options.strata = strata.split(",", QString::SkipEmptyParts);
+    options.top = top;
+
+    if (gold=="all" && !options.strata.isEmpty())
+    {
+        print("Options -g all and -b cannot be used together.");
+        return 2;
+    }
+
+    if (top>0 && (gold=="all" || !options.strata.isEmpty()))
+    {
+        print("Option -k cannot be used with -g all or -b.");
+        return 2;
+    }
+
+    if (!ok_cl || options.confidence<=0.0 || options.confidence>=1.0)
+    {
+        print("Confidence level has to be between 0 and 1.");
+        return 2;
+    }
+
+    if (!ok_pv || options.pvalue<=0.0 || options.pvalue>=1.0)
+    {
+        print("P-value threshold has to be between 0 and 1.");
+        return 2;
+    }
+
+    if (measures=="all")
+    {
+        options.measures = ALL;
+    }
+    else if (measures=="sensitivity")
+    {
+        options.measures = SENONLY;
+    }
+    else if (measures=="specificity")
+    {
+        options.measures = SPEONLY;
+    }
+    else
+    {
+        print("Measures have to be all, sensitivity or specificity.");
+        return 2;
+    }
+
+    if (inputs.length()>1 || !directory.isNull())
+    {
+        if (!output.isNull())
+        {
+            print("Option -o can be used with one input only, see -d.");
+            return 2;
+        }
+
+        return batch(inputs, options, directory, suffix, jobs, budget);
+    }
+
+    QString input = inputs.first();
+
+    if (output.isNull())
+    {
+        if (input=="-")
+        {
+            print("Output file of standard input has to be given with -o.");
+            return 2;
+        }
+
+        // the same default as Save Results, a dot in names of directories does not start the suffix
+        QFileInfo info(input);
+        QString name = info.completeBaseName() + "_out";
+
+        if (!info.suffix().isEmpty())
+        {
+            name += "." + info.suffix();
+        }
+
+        output = QDir(info.absolutePath()).filePath(name);
+    }
+
+    QString error;
+    int code = process(input, output, options, NULL, &error);
+
+    if (code!=0)
+    {
+        print(error);
+    }
+
+    return code;
+}
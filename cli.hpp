@@ -0,0 +1,84 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CLI_HPP
+#define CLI_HPP
+
+#include <QString>
+#include <QStringList>
+
+/*!
+  Batch mode without graphical interface: reads data file (or standard
+  input), calculates results for options of command line and saves them
+  as Save Results does (format chosen by suffix of output file). Nothing
+  but QCoreApplication is needed, so it runs on servers without display.
+
+  Many input files are processed at the same time by a pool of jobs, each
+  reading, calculating and saving one file; calculations of all jobs share
+  the global thread pool of QtConcurrent.
+*/
+namespace cli
+{
+    //! text printed by -h
+    const QString USAGE =
+            "Usage: bdtcomparator [options] INPUT...\n"
+            "Compares binary diagnostic tests in tab-delimited file INPUT (- reads\n"
+            "standard input) and saves results without graphical interface.\n"
+            "\n"
+            "  -o FILE      output file, default INPUT_out.txt; suffix .tsv saves long\n"
+            "               format, .bdtc columnar binary file, .gz compresses\n"
+            "  -g COLUMN    gold standard, name or number of column from 1 (default 1),\n"
+            "               all - every column in turn, results saved one after another\n"
+            "  -c LEVEL     confidence level (default 0.95)\n"
+            "  -p VALUE     p-value threshold (default 0.05)\n"
+            "  -m MEASURES  all, sensitivity or specificity (default all)\n"
+            "  -b COLUMNS   strata, names or numbers of columns separated by commas\n"
+            "               (any values); results of every group of rows with the\n"
+            "               same values and of all rows are saved one after another\n"
+            "  -k PAIRS     save only PAIRS pairs of tests with smallest p-values of\n"
+            "               accuracy, sensitivity and specificity instead of pairwise\n"
+            "               tables (text output)\n"
+            "  -h           print this help\n"
+            "\n"
+            "Many inputs (wildcards like *.txt are expanded, @LIST reads names of\n"
+            "files from LIST, one per line) are processed at the same time:\n"
+            "\n"
+            "  -d DIR       directory of outputs and of index.txt summarizing all\n"
+            "               files, default: outputs next to inputs, index printed\n"
+            "  -s SUFFIX    suffix of outputs instead of _out.txt, e.g. _out.tsv.gz\n"
+            "  -j JOBS      files processed at the same time (default number of cores)\n"
+            "  -M MB        memory for loaded files (default 1024), larger files wait\n";
+
+    //! memory budget (MB) of files loaded at the same time
+    const int MEMORY_BUDGET = 1024;
+
+    //! loaded data takes about this many times more memory than its file
+    const int MEMORY_FACTOR = 20;
+
+    /*!
+      are there options of batch mode or inputs among arguments of program;
+      options of Qt (e.g. -style) and of the system are left to the
+      graphical interface
+    */
+    bool isBatch(const QStringList &arguments);
+
+    //! runs batch mode for arguments of program, returns exit code
+    int run(const QStringList &arguments);
+}
+
+#endif // CLI_HPP
@@ -0,0 +1,228 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cooccurrence.hpp"
+#include "results.hpp"
+
+#include <QList>
+#include <QtConcurrentMap>
+
+#include <climits>
+
+cooccurrence::CountColumn::CountColumn(const BinaryData *input, int *pairs, int *triples)
+{
+    this->input = input;
+    this->pairs = pairs;
+    this->triples = triples;
+}
+
+void cooccurrence::CountColumn::operator()(const int &k) const
+{
+    int n_cols = input->columnCount();
+
+    pairs[k * n_cols + k] = input->count(k);
+
+    for (int j=0; j<k; j++)
+    {
+        int both = input->countBoth(j, k);
+
+        pairs[j * n_cols + k] = both;
+        pairs[k * n_cols + j] = both;
+
+        for (int i=0; i<j; i++)
+        {
+            triples[tripleIndex(i, j, k)] = input->countAll(i, j, k);
+        }
+    }
+}
+
+Cooccurrence::Cooccurrence(const BinaryData &input, bool count) :
+    bits(input)
+{
+    n_cols = bits.columnCount();
+
+    pairs.fill(0, n_cols * n_cols);
+    triples.fill(0, (int)cooccurrence::tripleIndex(0, 0, n_cols));
+    row_sums = bits.rowSums();
+
+    if (!count)
+    {
+        return;
+    }
+
+    QList<int> columns;
+
+    for (int k=0; k<n_cols; k++)
+    {
+        columns << k;
+    }
+
+    QtConcurrent::blockingMap(columns, cooccurrence::CountColumn(&bits, pairs.data(), triples.data()));
+}
+
+void Cooccurrence::add(const Cooccurrence &part)
+{
+    for (int k=0; k<pairs.size(); k++)
+    {
+        pairs[k] += part.pairs.at(k);
+    }
+
+    for (int k=0; k<triples.size(); k++)
+    {
+        triples[k] += part.triples.at(k);
+    }
+}
+
+qint64 Cooccurrence::size(int n_cols)
+{
+    return (cooccurrence::tripleIndex(0, 0, n_cols) + (qint64)n_cols * n_cols) * sizeof(int);
+}
+
+bool Cooccurrence::fits(int n_cols, int budget)
+{
+    // vectors hold at most INT_MAX numbers
+    if (cooccurrence::tripleIndex(0, 0, n_cols) > INT_MAX || (qint64)n_cols * n_cols > INT_MAX)
+    {
+        return false;
+    }
+
+    return budget<=0 || size(n_cols) <= (qint64)budget * 1024 * 1024;
+}
+
+int Cooccurrence::countAll(int i, int j, int k) const
+{
+    if (i>j)
+    {
+        qSwap(i, j);
+    }
+
+    if (j>k)
+    {
+        qSwap(j, k);
+    }
+
+    if (i>j)
+    {
+        qSwap(i, j);
+    }
+
+    return triples.at((int)cooccurrence::tripleIndex(i, j, k));
+}
+
+void Cooccurrence::crossTabulate(int gc, bool value, int i, int j, double *n) const
+{
+    int both = countAll(i, j, gc);
+    int n_i = countBoth(i, gc);
+    int n_j = countBoth(j, gc);
+    int n_rows = count(gc);
+
+    // rows with zero in gc are the rest of all rows
+    if (!value)
+    {
+        both = countBoth(i, j) - both;
+        n_i = count(i) - n_i;
+        n_j = count(j) - n_j;
+        n_rows = rowCount() - n_rows;
+    }
+
+    n[0] = both;
+    n[1] = n_i - both;
+    n[2] = n_j - both;
+    n[3] = n_rows - n[0] - n[1] - n[2];
+}
+
+int Cooccurrence::comparisonRowCount(int x, int gc) const
+{
+    switch (x)
+    {
+    case SEN:
+        return count(gc);
+    case SPE:
+        return rowCount() - count(gc);
+    default:
+        return rowCount();
+    }
+}
+
+int Cooccurrence::comparisonCount(int x, int gc, int j) const
+{
+    int positive = countBoth(j, gc);
+    int negative = rowCount() - count(j) - count(gc) + positive;
+
+    switch (x)
+    {
+    case SEN:
+        return positive;
+    case SPE:
+        return negative;
+    default:
+        return positive + negative;
+    }
+}
+
+int Cooccurrence::comparisonCountBoth(int x, int gc, int i, int j) const
+{
+    int positive = countAll(i, j, gc);
+    int negative = rowCount() - count(i) - count(j) - count(gc) + countBoth(i, j) + countBoth(i, gc) + countBoth(j, gc) - positive;
+
+    switch (x)
+    {
+    case SEN:
+        return positive;
+    case SPE:
+        return negative;
+    default:
+        return positive + negative;
+    }
+}
+
+QVector<int> Cooccurrence::comparisonRowSums(int x, int gc) const
+{
+    int n_rows = rowCount();
+    int m = n_cols - 1;
+
+    QVector<int> output;
+    output.reserve(comparisonRowCount(x, gc));
+
+    for (int r=0; r<n_rows; r++)
+    {
+        bool diseased = bits.at(r, gc);
+        int positive = row_sums.at(r) - (diseased ? 1 : 0);
+
+        // rows of tests agreeing with gold standard, diseased ones, healthy ones with zeros swapped
+        switch (x)
+        {
+        case SEN:
+            if (diseased)
+            {
+                output << positive;
+            }
+            break;
+        case SPE:
+            if (!diseased)
+            {
+                output << m - positive;
+            }
+            break;
+        default:
+            output << (diseased ? positive : m - positive);
+        }
+    }
+
+    return output;
+}
@@ -0,0 +1,129 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COOCCURRENCE_HPP
+#define COOCCURRENCE_HPP
+
+#include <QVector>
+
+#include "binarydata.hpp"
+
+namespace cooccurrence
+{
+    //! counts pairs and triples of columns whose last column is k, for QtConcurrent::blockingMap
+    struct CountColumn
+    {
+        CountColumn(const BinaryData *input, int *pairs, int *triples);
+
+        void operator()(const int &k) const;
+
+        const BinaryData *input;
+        int *pairs;
+        int *triples;
+    };
+
+    //! returns position of triple of columns i<j<k
+    inline qint64 tripleIndex(int i, int j, int k)
+    {
+        return (qint64)k * (k - 1) * (k - 2) / 6 + (qint64)j * (j - 1) / 2 + i;
+    }
+}
+
+/*!
+  Numbers of rows with ones in every pair and every triple of columns of
+  packed data. They do not depend on which column is the gold standard, so
+  once counted they give cross-tabulations for every choice of it without
+  selecting rows again (see Calculator::setCooccurrence()). Triples take
+  m^3 / 6 numbers for m columns, so check fits() before counting them.
+*/
+class Cooccurrence
+{
+public:
+    /*!
+      counts pairs and triples of columns of input, the data is shared with
+      input; counts are zero if not count, e.g. of input made of rows of
+      parts counted one by one, see add()
+    */
+    explicit Cooccurrence(const BinaryData &input, bool count = true);
+
+    //! adds counts of part of rows of the data
+    void add(const Cooccurrence &part);
+
+    //! returns number of bytes of counts of n_cols columns
+    static qint64 size(int n_cols);
+
+    /*!
+      can counts of n_cols columns be kept within budget (MB, 0 if
+      unlimited, see Params::getMemoryBudget())
+    */
+    static bool fits(int n_cols, int budget);
+
+    int rowCount() const
+    {
+        return bits.rowCount();
+    }
+
+    int columnCount() const
+    {
+        return n_cols;
+    }
+
+    //! returns number of ones in column x
+    int count(int x) const
+    {
+        return pairs.at(x * n_cols + x);
+    }
+
+    //! returns number of rows with ones in both columns i and j
+    int countBoth(int i, int j) const
+    {
+        return pairs.at(i * n_cols + j);
+    }
+
+    //! returns number of rows with ones in columns i, j and k (all different)
+    int countAll(int i, int j, int k) const;
+
+    //! counts rows with (1,1), (1,0), (0,1) and (0,0) in columns i and j among rows with value in column gc
+    void crossTabulate(int gc, bool value, int i, int j, double *n) const;
+
+    /*!
+      numbers of rows, ones in column j, ones in both columns i and j and
+      sums of rows (column gc skipped) of data compared by McNemar test for
+      measure x, see Calculator::comparisonData()
+    */
+    int comparisonRowCount(int x, int gc) const;
+    int comparisonCount(int x, int gc, int j) const;
+    int comparisonCountBoth(int x, int gc, int i, int j) const;
+    QVector<int> comparisonRowSums(int x, int gc) const;
+
+private:
+    BinaryData bits;
+
+    int n_cols;
+
+    //! symmetric matrix of pairs, counts of columns on diagonal
+    QVector<int> pairs;
+
+    //! triples i<j<k, see cooccurrence::tripleIndex()
+    QVector<int> triples;
+
+    //! sums of all columns of every row
+    QVector<int> row_sums;
+};
+
+#endif // COOCCURRENCE_HPP
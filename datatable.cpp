@@ -18,14 +18,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "datatable.hpp"
 
+#include <cstdio>
+
 DataTable::DataTable(const QString &input, Params *params, QObject *parent) :
     QAbstractTableModel(parent)
 {   
     this->params = params;
     
     QFile file(input);
+    
+    bool opened = input=="-" ? file.open(stdin, QIODevice::ReadOnly) : file.open(QIODevice::ReadOnly);
 
-    if (file.open(QIODevice::ReadOnly))
+    if (opened)
     {
         QTextStream data(&file);
 
@@ -35,6 +39,13 @@ DataTable::DataTable(const QString &input, Params *params, QObject *parent) :
 
         int length = header.length();
 
+        QList<bool> strata;
+
+        for (int i=0; i<length; i++)
+        {
+            strata.append(isStratum(i));
+        }
+
         bool exit = false;
         int row_number = 1;
         int col_number = 0;
@@ -49,7 +60,7 @@ DataTable::DataTable(const QString &input, Params *params, QObject *parent) :
             for (int i=0; i<length; i++)
             {
                 value = row.at(i).simplified();
-                if (value!="0" && value!="1" && value!="")
+                if (value!="0" && value!="1" && value!="" && !strata.at(i))
                 {
                     col_number = i + 1;
                     exit = true;
@@ -67,12 +78,8 @@ DataTable::DataTable(const QString &input, Params *params, QObject *parent) :
                 header.clear();
                 rows.clear();
 
-                QMessageBox msgBox;
-                QString message = "Ilegal character '%1' in iput at (row: %2; col: %3).";
-                message = message.arg(value, QString::number(row_number), QString::number(col_number));
-                msgBox.setText(message);
-                msgBox.setIcon(QMessageBox::Critical);
-                msgBox.exec();
+                error = "Ilegal character '%1' in iput at (row: %2; col: %3).";
+                error = error.arg(value, QString::number(row_number), QString::number(col_number));
 
                 break;
             }
@@ -82,4 +89,9 @@ DataTable::DataTable(const QString &input, Params *params, QObject *parent) :
         
         file.close();
     }
+    else
+    {
+        error = "Cannot read file %1.";
+        error = error.arg(input);
+    }
 }
@@ -23,7 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFile>
 #include <QTextStream>
 #include <QStringList>
-#include <QMessageBox>
+#include <QBrush>
+#include <QColor>
 
 #include "params.hpp"
 
@@ -32,7 +33,14 @@ class DataTable : public QAbstractTableModel
     Q_OBJECT
 
 public:
+    //! reads tab-delimited file input, - reads standard input
     explicit DataTable(const QString &input, Params *params, QObject *parent = 0);
+    
+    //! returns description of error of reading or empty string
+    QString errorString() const
+    {
+        return error;
+    }
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const
     {
@@ -120,6 +128,14 @@ public:
         return rows.at(x);
     }
     
+    //! is column x a stratum column of params (by name or number from 1), see Params::getStrata()
+    bool isStratum(int x) const
+    {
+        QStringList strata = params->getStrata();
+        
+        return strata.contains(header.at(x)) || strata.contains(QString::number(x + 1));
+    }
+    
     bool isActive(int x) const
     {
         return active_rows.at(x);
@@ -141,6 +157,8 @@ private:
     QList<bool> active_rows;
     QList<QStringList> rows;
     
+    QString error;
+    
     Params *params;
     
 };
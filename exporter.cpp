@@ -0,0 +1,604 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "exporter.hpp"
+#include "formatter.hpp"
+
+#include <QtConcurrentRun>
+
+#include <cstring>
+#include <limits>
+
+#include <zlib.h>
+
+exporter::Writer::Writer(QFile *file, bool compress)
+{
+    this->file = file;
+    this->buffer.resize(BUFFER_SIZE);
+    this->pending.resize(BUFFER_SIZE);
+    this->used = 0;
+    this->written = 0;
+    this->ok = true;
+    this->staged = false;
+    this->stream = NULL;
+
+    if (compress)
+    {
+        stream = new z_stream;
+        stream->zalloc = Z_NULL;
+        stream->zfree = Z_NULL;
+        stream->opaque = Z_NULL;
+
+        // gzip header, fast level keeps compression below disk time
+        ok = deflateInit2(stream, COMPRESSION_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)==Z_OK;
+
+        compressed.resize(BUFFER_SIZE);
+    }
+}
+
+exporter::Writer::~Writer()
+{
+    wait();
+
+    if (stream!=NULL)
+    {
+        deflateEnd(stream);
+        delete stream;
+    }
+}
+
+void exporter::Writer::append(const char *data, int length)
+{
+    if (used + length > BUFFER_SIZE)
+    {
+        flush();
+    }
+
+    // longer than buffer, written at once
+    if (length > BUFFER_SIZE)
+    {
+        wait();
+        ok = write(data, length, Z_NO_FLUSH) && ok;
+        written += length;
+        return;
+    }
+
+    memcpy(buffer.data() + used, data, length);
+    used += length;
+}
+
+void exporter::Writer::flush()
+{
+    wait();
+
+    if (used==0)
+    {
+        return;
+    }
+
+    qSwap(buffer, pending);
+
+    stage = QtConcurrent::run(this, &Writer::write, (const char *)pending.constData(), used, (int)Z_NO_FLUSH);
+    staged = true;
+
+    written += used;
+    used = 0;
+}
+
+bool exporter::Writer::close()
+{
+    flush();
+    wait();
+
+    if (stream!=NULL)
+    {
+        ok = write(NULL, 0, Z_FINISH) && ok;
+    }
+
+    return ok;
+}
+
+void exporter::Writer::wait()
+{
+    if (staged)
+    {
+        ok = stage.result() && ok;
+        staged = false;
+    }
+}
+
+bool exporter::Writer::write(const char *data, int length, int mode)
+{
+    if (stream==NULL)
+    {
+        return file->write(data, length)==length;
+    }
+
+    stream->next_in = (Bytef *)data;
+    stream->avail_in = length;
+
+    // output is written whenever compressed buffer is full
+    do
+    {
+        stream->next_out = (Bytef *)compressed.data();
+        stream->avail_out = compressed.size();
+
+        if (deflate(stream, mode)==Z_STREAM_ERROR)
+        {
+            return false;
+        }
+
+        int have = compressed.size() - stream->avail_out;
+
+        if (have>0 && file->write(compressed.constData(), have)!=have)
+        {
+            return false;
+        }
+    }
+    while (stream->avail_out==0);
+
+    return true;
+}
+
+bool exporter::isCompressed(const QString &filename)
+{
+    return filename.endsWith(".gz", Qt::CaseInsensitive);
+}
+
+QList<exporter::Table> exporter::tables(const Results *results)
+{
+    QList<Table> output;
+
+    for (int id=0; id<NTABLES; id++)
+    {
+        if (!results->hasTable(id))
+        {
+            continue;
+        }
+
+        Table table;
+        table.name = RESULTS.at(id);
+        table.table = results->table(id);
+
+        // pairwise comparisons are not calculated for one test
+        if (id>0 && table.table->storedRowCount()==0)
+        {
+            continue;
+        }
+
+        output << table;
+    }
+
+    return output;
+}
+
+bool exporter::save(const QString &filename, const QList<Table> &tables, bool append)
+{
+    QFile file(filename);
+
+    if (!file.open(append ? QIODevice::WriteOnly | QIODevice::Append : QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    Writer output(&file, isCompressed(filename));
+
+    for (int t=0; t<tables.size(); t++)
+    {
+        const ResultsTable *res = tables.at(t).table;
+
+        output.append(tables.at(t).name);
+        output.append('\n');
+
+        for (int j=0; j<NINFO; j++)
+        {
+            if (!res->info[j].isEmpty())
+            {
+                output.append(res->info[j]);
+                output.append('\n');
+            }
+        }
+
+        int n_rows = res->storedRowCount();
+        int n_cols = res->columnCount();
+
+        // headers are in order of views
+        for (int k=0; k<n_cols; k++)
+        {
+            output.append('\t');
+            output.append(res->headerData(k, Qt::Horizontal).toString());
+        }
+
+        output.append('\n');
+
+        QVector<int> columns(n_cols);
+
+        for (int k=0; k<n_cols; k++)
+        {
+            columns[k] = res->sourceColumn(k);
+        }
+
+        for (int j=0; j<n_rows; j++)
+        {
+            int row = res->sourceRow(j);
+
+            output.append(res->headerData(j, Qt::Vertical).toString());
+
+            for (int k=0; k<n_cols; k++)
+            {
+                output.append('\t');
+
+                char *cell = output.reserve(4 * formatter::MAX_LENGTH);
+                output.commit(res->format(row, columns.at(k), cell));
+            }
+
+            output.append('\n');
+        }
+
+        output.append('\n');
+    }
+
+    bool ok = output.close();
+
+    file.close();
+
+    return ok;
+}
+
+namespace
+{
+    //! flags of records in columnar files
+    const quint8 HAS_ESTIMATE = 1;
+    const quint8 HAS_BOUNDS = 2;
+    const quint8 HAS_PVALUE = 4;
+
+    const char MAGIC[8] = {'B', 'D', 'T', 'C', 'O', 'L', '1', '\0'};
+
+    template <typename T>
+    void appendValue(exporter::Writer &output, T value)
+    {
+        output.append((const char *)&value, sizeof(T));
+    }
+
+    void appendString(exporter::Writer &output, const QString &text)
+    {
+        QByteArray bytes = text.toUtf8();
+
+        appendValue<qint32>(output, bytes.size());
+        output.append(bytes.constData(), bytes.size());
+    }
+
+    //! appends n values of array, missing array is written as NaN
+    void appendColumn(exporter::Writer &output, const double *values, qint64 n)
+    {
+        if (values==NULL)
+        {
+            for (qint64 k=0; k<n; k++)
+            {
+                appendValue<double>(output, std::numeric_limits<double>::quiet_NaN());
+            }
+        }
+        else
+        {
+            // large arrays go straight from tables to file
+            const qint64 chunk = 1 << 27;
+
+            for (qint64 k=0; k<n; k+=chunk)
+            {
+                output.append((const char *)(values + k), (int)(qMin(chunk, n - k) * sizeof(double)));
+            }
+        }
+
+        output.pad(8);
+    }
+
+    quint8 flags(int type)
+    {
+        switch (type)
+        {
+        case EMPTY:
+            return 0;
+        case CI:
+            return HAS_ESTIMATE | HAS_BOUNDS;
+        case PV:
+            return HAS_PVALUE;
+        default:
+            return HAS_ESTIMATE;
+        }
+    }
+
+    /*!
+      writes one batch of records, one for each stored entry of table;
+      metric of columns of table is metrics[column] and test compared with
+      every row is reference (-1 for column of entry); p-values come from
+      pvalues which has the same shape as table
+    */
+    void appendBatch(exporter::Writer &output, qint32 kind, const ResultsTable *table, const ResultsTable *pvalues,
+                     const QVector<int> &metrics, int reference)
+    {
+        qint64 n = table->entryCount();
+        int n_rows = table->storedRowCount();
+
+        appendValue<qint32>(output, kind);
+        appendValue<qint32>(output, metrics.size()==1 ? metrics.at(0) : -1);
+        appendValue<qint64>(output, n);
+
+        for (int i=0; i<n_rows; i++)
+        {
+            for (int k=table->begin(i); k<table->end(i); k++)
+            {
+                appendValue<qint32>(output, i);
+            }
+        }
+
+        output.pad(8);
+
+        for (int i=0; i<n_rows; i++)
+        {
+            for (int k=table->begin(i); k<table->end(i); k++)
+            {
+                appendValue<qint32>(output, pvalues==NULL ? -1 : (reference>=0 ? reference : table->columnAt(k)));
+            }
+        }
+
+        output.pad(8);
+
+        for (int i=0; i<n_rows; i++)
+        {
+            for (int k=table->begin(i); k<table->end(i); k++)
+            {
+                appendValue<qint32>(output, metrics.at(metrics.size()==1 ? 0 : table->columnAt(k)));
+            }
+        }
+
+        output.pad(8);
+
+        // dense tables of p-values share layout of table
+        bool aligned = pvalues!=NULL && !pvalues->isSparse() && pvalues->entryCount()==n;
+
+        for (int i=0; i<n_rows; i++)
+        {
+            for (int k=table->begin(i); k<table->end(i); k++)
+            {
+                quint8 flag = flags(table->typeAt(k));
+
+                if (pvalues!=NULL && (aligned ? pvalues->typeAt(k) : pvalues->type(i, table->columnAt(k)))==PV)
+                {
+                    flag |= HAS_PVALUE;
+                }
+
+                appendValue<quint8>(output, flag);
+            }
+        }
+
+        output.pad(8);
+
+        appendColumn(output, table->entryData(EST), n);
+        appendColumn(output, table->entryData(LOW), n);
+        appendColumn(output, table->entryData(UPP), n);
+
+        if (pvalues==NULL || aligned)
+        {
+            appendColumn(output, pvalues==NULL ? NULL : pvalues->entryData(EST), n);
+            return;
+        }
+
+        for (int i=0; i<n_rows; i++)
+        {
+            for (int k=table->begin(i); k<table->end(i); k++)
+            {
+                appendValue<double>(output, pvalues->value(i, table->columnAt(k)));
+            }
+        }
+
+        output.pad(8);
+    }
+}
+
+bool exporter::saveColumnar(const QString &filename, const Results *results)
+{
+    QFile file(filename);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    Writer output(&file, isCompressed(filename));
+
+    const ResultsTable *measures = results->confidence_intervals;
+
+    QStringList tests = measures->verticalHeader();
+
+    QVector<int> metrics;
+    QList<int> pairwise;
+
+    for (int x=0; x<NRESULTS; x++)
+    {
+        if (results->isAvailable(x))
+        {
+            metrics << x;
+
+            if (results->isPairwiseCalculated(x) && results->pc_ci[x]->storedRowCount()>0)
+            {
+                pairwise << x;
+            }
+        }
+    }
+
+    output.append(MAGIC, sizeof(MAGIC));
+    appendValue<qint32>(output, 1);
+
+    appendValue<qint32>(output, tests.length());
+
+    for (int k=0; k<tests.length(); k++)
+    {
+        appendString(output, tests.at(k));
+    }
+
+    appendValue<qint32>(output, NRESULTS);
+
+    for (int x=0; x<NRESULTS; x++)
+    {
+        appendString(output, HEADER.at(x));
+    }
+
+    output.pad(8);
+
+    appendValue<qint32>(output, 1 + pairwise.size());
+    appendValue<qint32>(output, 0);
+
+    appendBatch(output, 0, measures, NULL, metrics, -1);
+
+    for (int t=0; t<pairwise.size(); t++)
+    {
+        int x = pairwise.at(t);
+
+        appendBatch(output, 1, results->pc_ci[x], results->pc_pv[x], QVector<int>() << x, results->getReferenceTest());
+    }
+
+    bool ok = output.close();
+
+    file.close();
+
+    return ok;
+}
+
+bool exporter::saveLong(const QString &filename, const Results *results, const Filter &filter)
+{
+    QFile file(filename);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    Writer output(&file, isCompressed(filename));
+
+    QStringList tests = results->confidence_intervals->verticalHeader();
+    int m = tests.length();
+
+    QList<QByteArray> names;
+
+    for (int k=0; k<m; k++)
+    {
+        names << tests.at(k).toLocal8Bit();
+    }
+
+    QVector<bool> selected(m, filter.tests.isEmpty());
+
+    // tests outside rows of tables are ignored
+    for (int k=0; k<filter.tests.size(); k++)
+    {
+        int test = filter.tests.at(k);
+
+        if (test>=0 && test<m)
+        {
+            selected[test] = true;
+        }
+    }
+
+    int reference = results->getReferenceTest();
+    bool all = filter.pvalue>=1.0;
+
+    output.append(QString("Metric\tTest i\tTest j\tEstimate\tLower\tUpper\tp-value\n"));
+
+    for (int x=0; x<NRESULTS; x++)
+    {
+        if (!results->isAvailable(x) || !results->isPairwiseCalculated(x))
+        {
+            continue;
+        }
+
+        const ResultsTable *ci = results->pc_ci[x];
+        const ResultsTable *pv = results->pc_pv[x];
+
+        QByteArray metric = HEADER.at(x).toLocal8Bit();
+
+        bool aligned = !pv->isSparse() && pv->entryCount()==ci->entryCount();
+
+        for (int i=0; i<ci->storedRowCount(); i++)
+        {
+            for (int k=ci->begin(i); k<ci->end(i); k++)
+            {
+                int col = ci->columnAt(k);
+
+                // each pair once, from the upper triangle
+                if ((reference<0 && col<=i) || ci->typeAt(k)==EMPTY)
+                {
+                    continue;
+                }
+
+                int j = reference>=0 ? reference : col;
+
+                if (!selected.at(i) && !selected.at(j))
+                {
+                    continue;
+                }
+
+                int p = aligned ? k : pv->find(i, col);
+                bool has_pvalue = p>=0 && pv->typeAt(p)==PV;
+
+                if (!all && (!has_pvalue || pv->valueAt(p) >= filter.pvalue))
+                {
+                    continue;
+                }
+
+                output.append(metric.constData(), metric.size());
+                output.append('\t');
+                output.append(names.at(i).constData(), names.at(i).size());
+                output.append('\t');
+                output.append(names.at(j).constData(), names.at(j).size());
+                output.append('\t');
+
+                char *cell = output.reserve(4 * formatter::MAX_LENGTH);
+                int length = formatter::fixed(ci->valueAt(k), 6, 0, cell);
+
+                if (ci->typeAt(k)==CI)
+                {
+                    cell[length++] = '\t';
+                    length += formatter::fixed(ci->valueAt(k, LOW), 6, 0, cell + length);
+                    cell[length++] = '\t';
+                    length += formatter::fixed(ci->valueAt(k, UPP), 6, 0, cell + length);
+                }
+                else
+                {
+                    cell[length++] = '\t';
+                    cell[length++] = '\t';
+                }
+
+                cell[length++] = '\t';
+
+                if (has_pvalue)
+                {
+                    length += formatter::fixed(pv->valueAt(p), 6, 0, cell + length);
+                }
+
+                cell[length++] = '\n';
+                output.commit(length);
+            }
+        }
+    }
+
+    bool ok = output.close();
+
+    file.close();
+
+    return ok;
+}
@@ -0,0 +1,188 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef EXPORTER_HPP
+#define EXPORTER_HPP
+
+#include <QFile>
+#include <QFuture>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "results.hpp"
+#include "resultstable.hpp"
+
+struct z_stream_s;
+
+/*!
+  Saving of results tables as tab-delimited text, the same as views show
+  them. Cells are formatted straight from arrays of tables into a large
+  buffer which is written to file whenever it is full, so no QVariant or
+  QString is created per cell and saving may run in another thread.
+  Columnar binary files are written from arrays of tables without
+  conversion, long-format files skip empty and mirrored cells. Files
+  named *.gz are compressed with gzip.
+*/
+namespace exporter
+{
+    //! size of output buffer written at once
+    const int BUFFER_SIZE = 1 << 22;
+
+    //! level of gzip compression, the fastest one
+    const int COMPRESSION_LEVEL = 1;
+
+    //! table to save and its name
+    struct Table
+    {
+        QString name;
+        const ResultsTable *table;
+    };
+
+    //! pairs of tests saved by saveLong()
+    struct Filter
+    {
+        Filter() : pvalue(1.0) {}
+
+        //! keeps pairs with p-value below, 1 keeps all pairs
+        double pvalue;
+        //! keeps pairs including one of tests (rows of tables, others are ignored), empty keeps all pairs
+        QList<int> tests;
+    };
+
+    /*!
+      buffered sequential writing to a file; a full buffer is handed to a
+      background stage which compresses (if asked) and writes it while the
+      next buffer is filled
+    */
+    class Writer
+    {
+    public:
+        //! compress - gzip output
+        explicit Writer(QFile *file, bool compress=false);
+        ~Writer();
+
+        void append(const char *data, int length);
+
+        void append(char c)
+        {
+            if (used==BUFFER_SIZE)
+            {
+                flush();
+            }
+
+            buffer[used++] = c;
+        }
+
+        //! text in local encoding, as QTextStream writes it
+        void append(const QString &text)
+        {
+            QByteArray bytes = text.toLocal8Bit();
+            append(bytes.constData(), bytes.size());
+        }
+
+        //! returns place for at most length bytes, see commit()
+        char *reserve(int length)
+        {
+            if (used + length > BUFFER_SIZE)
+            {
+                flush();
+            }
+
+            return buffer.data() + used;
+        }
+
+        //! keeps length bytes written to place returned by reserve()
+        void commit(int length)
+        {
+            used += length;
+        }
+
+        //! hands buffer to background stage without waiting for it
+        void flush();
+
+        //! writes everything and ends compressed stream, returns false if any write failed
+        bool close();
+
+        //! number of (uncompressed) bytes appended so far
+        qint64 position() const
+        {
+            return written + used;
+        }
+
+        //! appends zeros up to position divisible by alignment
+        void pad(int alignment)
+        {
+            while (position() % alignment!=0)
+            {
+                append('\0');
+            }
+        }
+
+    private:
+        //! waits for background stage
+        void wait();
+
+        //! compresses (if asked) and writes data, mode is flush mode of deflate()
+        bool write(const char *data, int length, int mode);
+
+        QFile *file;
+        QVector<char> buffer;
+        int used;
+        qint64 written;
+        bool ok;
+
+        //! buffer written by background stage
+        QVector<char> pending;
+        QFuture<bool> stage;
+        bool staged;
+
+        z_stream_s *stream;
+        QVector<char> compressed;
+    };
+
+    //! is file gzip compressed, by suffix .gz of filename
+    bool isCompressed(const QString &filename);
+
+    //! returns tables of results in order of views, tables without rows are skipped
+    QList<Table> tables(const Results *results);
+
+    /*!
+      writes tables to file filename (after its content if append, a
+      compressed file gets another gzip member), returns false if it cannot
+      be written
+    */
+    bool save(const QString &filename, const QList<Table> &tables, bool append=false);
+
+    /*!
+      writes measures and calculated pairwise comparisons of results to file
+      filename in columnar binary format (see README.TXT), returns false if
+      it cannot be written
+    */
+    bool saveColumnar(const QString &filename, const Results *results);
+
+    /*!
+      writes calculated pairwise comparisons of results to file filename,
+      one tab-delimited line per metric and pair of tests (each pair once)
+      which passes filter, returns false if it cannot be written
+    */
+    bool saveLong(const QString &filename, const Results *results, const Filter &filter);
+}
+
+#endif // EXPORTER_HPP
@@ -0,0 +1,120 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "formatter.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//! powers of ten for supported numbers of decimals
+static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+int formatter::fixed(double x, int decimals, int width, char *out)
+{
+    double scaled = fabs(x) * POWERS[decimals < 9 ? decimals : 9];
+
+    /*
+      nan, infinity, large numbers and ties of rounding are left to printf;
+      below 1e9 the error of scaled is far below the margin of ties, so it
+      is rounded as printf rounds x
+    */
+    if (decimals>9 || !(scaled < 1e9) || fabs(scaled - floor(scaled) - 0.5) < 1e-6)
+    {
+        char buffer[512];
+        int length = snprintf(buffer, sizeof(buffer), "%*.*f", width, decimals, x);
+
+        // numbers too long for fixed-point notation (e.g. huge likelihood ratios) are written with exponent
+        if (length<0 || length>=MAX_LENGTH)
+        {
+            length = snprintf(buffer, sizeof(buffer), "%*.*g", width < MAX_LENGTH ? width : 0, decimals < 15 ? decimals + 1 : 16, x);
+        }
+
+        if (length<0 || length>=MAX_LENGTH)
+        {
+            length = 0;
+        }
+
+        memcpy(out, buffer, length);
+
+        return length;
+    }
+
+    unsigned long long digits = (unsigned long long)(scaled + 0.5);
+
+    char buffer[MAX_LENGTH];
+    int length = 0;
+
+    // digits from the last one
+    for (int d=0; d<decimals; d++)
+    {
+        buffer[length++] = '0' + (char)(digits % 10ULL);
+        digits /= 10ULL;
+    }
+
+    if (decimals>0)
+    {
+        buffer[length++] = '.';
+    }
+
+    do
+    {
+        buffer[length++] = '0' + (char)(digits % 10ULL);
+        digits /= 10ULL;
+    }
+    while (digits>0ULL);
+
+    // printf keeps the sign of negative numbers rounded to zero and of -0.0
+    if (x<0.0 || (x==0.0 && 1.0 / x < 0.0))
+    {
+        buffer[length++] = '-';
+    }
+
+    int n = 0;
+
+    while (n + length < width)
+    {
+        out[n++] = ' ';
+    }
+
+    while (length>0)
+    {
+        out[n++] = buffer[--length];
+    }
+
+    return n;
+}
+
+int formatter::interval(double est, double low, double upp, char *out)
+{
+    int n = fixed(est, 3, 6, out);
+
+    out[n++] = ' ';
+    out[n++] = '(';
+
+    n += fixed(low, 3, 6, out + n);
+
+    out[n++] = ';';
+
+    n += fixed(upp, 3, 6, out + n);
+
+    out[n++] = ')';
+
+    return n;
+}
@@ -0,0 +1,45 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FORMATTER_HPP
+#define FORMATTER_HPP
+
+/*!
+  Fixed-point formatting of doubles into caller's buffer, the same output
+  as printf("%*.*f") (and QString::number(x, 'f', decimals)) without
+  locale handling and memory allocation.
+*/
+namespace formatter
+{
+    //! longest output of fixed()
+    const int MAX_LENGTH = 32;
+
+    /*!
+      writes x with given number of decimals right-aligned to width (or
+      with exponent and decimals + 1 significant digits if it would take
+      MAX_LENGTH characters or more), returns number of characters written
+      (no terminating zero)
+    */
+    int fixed(double x, int decimals, int width, char *out);
+
+    //! writes estimate and bounds as "est (low;upp)" with 3 decimals in columns of 6
+    int interval(double est, double low, double upp, char *out);
+}
+
+#endif // FORMATTER_HPP
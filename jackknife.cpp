@@ -0,0 +1,166 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "jackknife.hpp"
+#include "results.hpp"
+
+double jackknife::measure(int id, double a, double b, double c, double d)
+{
+    switch (id)
+    {
+    case ACC:
+        return (a + d) / (a + b + c + d);
+    case SEN:
+        return a / (a + c);
+    case SPE:
+        return d / (b + d);
+    }
+
+    // the same correction of empty cells as for confidence intervals
+    if (a<0.5)
+    {
+        a = 0.1;
+    }
+    if (b<0.5)
+    {
+        b = 0.1;
+    }
+    if (c<0.5)
+    {
+        c = 0.1;
+    }
+    if (d<0.5)
+    {
+        d = 0.1;
+    }
+
+    switch (id)
+    {
+    case PPV:
+        return a / (a + b);
+    case NPV:
+        return d / (c + d);
+    case LRP:
+        return (a / (a + c)) / (b / (b + d));
+    case LRN:
+        return (c / (a + c)) / (d / (b + d));
+    default:
+        return 0.0;
+    }
+}
+
+void jackknife::counts(const BinaryData *input, int gc, int x, double *n)
+{
+    double a = input->countBoth(gc, x);
+
+    n[0] = a;
+    n[1] = input->count(x) - a;
+    n[2] = input->count(gc) - a;
+    n[3] = input->rowCount() - n[0] - n[1] - n[2];
+}
+
+void jackknife::counts(const BinaryData *input, int gc, int i, int j, double *n)
+{
+    double all = input->countAll(gc, i, j);
+    double gi = input->countBoth(gc, i);
+    double gj = input->countBoth(gc, j);
+    double ij = input->countBoth(i, j);
+
+    // inclusion-exclusion, index is gold * 4 + test i * 2 + test j
+    n[7] = all;
+    n[6] = gi - all;
+    n[5] = gj - all;
+    n[4] = input->count(gc) - gi - gj + all;
+    n[3] = ij - all;
+    n[2] = input->count(i) - gi - ij + all;
+    n[1] = input->count(j) - gj - ij + all;
+    n[0] = input->rowCount() - n[1] - n[2] - n[3] - n[4] - n[5] - n[6] - n[7];
+}
+
+void jackknife::leaveOneOut(int id, const double *n, double *loo)
+{
+    for (int k=0; k<4; k++)
+    {
+        double m[4] = {n[0], n[1], n[2], n[3]};
+
+        m[k] -= 1.0;
+
+        loo[k] = measure(id, m[0], m[1], m[2], m[3]);
+    }
+}
+
+double jackknife::difference(int id, const double *n)
+{
+    // 2x2 tables of both tests against gold standard
+    double ai = n[6] + n[7], bi = n[2] + n[3], ci = n[4] + n[5], di = n[0] + n[1];
+    double aj = n[5] + n[7], bj = n[1] + n[3], cj = n[4] + n[6], dj = n[0] + n[2];
+
+    return measure(id, ai, bi, ci, di) - measure(id, aj, bj, cj, dj);
+}
+
+void jackknife::leaveOneOutDifference(int id, const double *n, double *loo)
+{
+    for (int k=0; k<8; k++)
+    {
+        double m[8];
+
+        for (int l=0; l<8; l++)
+        {
+            m[l] = n[l];
+        }
+
+        m[k] -= 1.0;
+
+        loo[k] = difference(id, m);
+    }
+}
+
+double jackknife::variance(const double *n, const double *loo, int n_cells)
+{
+    double total = 0.0;
+    double mean = 0.0;
+
+    for (int k=0; k<n_cells; k++)
+    {
+        if (n[k]>0.0)
+        {
+            total += n[k];
+            mean += n[k] * loo[k];
+        }
+    }
+
+    if (total<2.0)
+    {
+        return 0.0;
+    }
+
+    mean /= total;
+
+    double sum = 0.0;
+
+    for (int k=0; k<n_cells; k++)
+    {
+        if (n[k]>0.0)
+        {
+            sum += n[k] * (loo[k] - mean) * (loo[k] - mean);
+        }
+    }
+
+    return (total - 1.0) / total * sum;
+}
@@ -0,0 +1,85 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef JACKKNIFE_HPP
+#define JACKKNIFE_HPP
+
+#include <QVector>
+
+#include "binarydata.hpp"
+
+/*!
+  Every measure of a test is a function of four counts and every pairwise
+  difference a function of eight counts (gold standard x test i x test j),
+  so removing one row just decrements the cell it belongs to. Leave-one-out
+  values are evaluated once per cell instead of once per row.
+*/
+namespace jackknife
+{
+    //! value of measure (ACC ... LRN) for true positives a, false positives b, false negatives c and true negatives d
+    double measure(int id, double a, double b, double c, double d);
+
+    //! cell of a test: 0 - true positive, 1 - false positive, 2 - false negative, 3 - true negative
+    inline int cell(bool test, bool gold)
+    {
+        return (test ? 0 : 2) + (gold ? 0 : 1);
+    }
+
+    //! cell of a pair of tests: gold * 4 + test i * 2 + test j
+    inline int cell(bool test_i, bool test_j, bool gold)
+    {
+        return (gold ? 4 : 0) + (test_i ? 2 : 0) + (test_j ? 1 : 0);
+    }
+
+    //! counts of four cells of test x against gold standard gc
+    void counts(const BinaryData *input, int gc, int x, double *n);
+
+    //! counts of eight cells of tests i and j against gold standard gc
+    void counts(const BinaryData *input, int gc, int i, int j, double *n);
+
+    //! leave-one-out values of measure for every of four cells
+    void leaveOneOut(int id, const double *n, double *loo);
+
+    //! difference of measure of tests i and j for counts of eight cells
+    double difference(int id, const double *n);
+
+    //! leave-one-out values of difference of measure of two tests for every of eight cells
+    void leaveOneOutDifference(int id, const double *n, double *loo);
+
+    //! jackknife variance from counts of cells and leave-one-out values
+    double variance(const double *n, const double *loo, int n_cells);
+
+    //! orders indices by descending score
+    struct ScoreGreaterThan
+    {
+        ScoreGreaterThan(const double *score)
+        {
+            this->score = score;
+        }
+
+        bool operator()(int i, int j) const
+        {
+            return score[i] > score[j];
+        }
+
+        const double *score;
+    };
+}
+
+#endif // JACKKNIFE_HPP
@@ -16,11 +16,28 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QtCore/QCoreApplication>
 #include <QtGui/QApplication>
 #include "mainwindow.hpp"
+#include "cli.hpp"
 
 int main(int argc, char *argv[])
 {
+    QStringList arguments;
+
+    for (int k=0; k<argc; k++)
+    {
+        arguments << QString::fromLocal8Bit(argv[k]);
+    }
+
+    // options of batch mode or inputs run it without any widgets
+    if (cli::isBatch(arguments))
+    {
+        QCoreApplication a(argc, argv);
+
+        return cli::run(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
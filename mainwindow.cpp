@@ -32,7 +32,11 @@ MainWindow::MainWindow(QWidget *parent) :
     this->data = NULL;
     this->results = NULL;
     this->current_result = NULL;
+    this->save_pending = false;
     this->calculator = new Calculator(NULL, NULL, params);
+    this->calculator->setLazy(true);
+    this->calculator->setStreaming(true);
+    this->simulation_dialog = new SimulationDialog(params, this);
     
     /* params */
     QObject::connect(params, SIGNAL(paramsChanged()), this, SLOT(clearResults()));
@@ -48,13 +52,48 @@ MainWindow::MainWindow(QWidget *parent) :
     
     /* Pairwise comparision Confidence Level */
     QObject::connect(ui->pcConfidenceLevelSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setPvalue(double)));
+    
+    /* Highlighting */
+    QObject::connect(ui->thresholdSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setThreshold(double)));
+    QObject::connect(params, SIGNAL(thresholdChanged()), this, SLOT(updateResults()));
+    
+    /* Exact and permutation tests */
+    QObject::connect(ui->permutationCheckBox, SIGNAL(toggled(bool)), params, SLOT(setPermutationTest(bool)));
+    
+    /* Multiple comparison adjustment */
+    ui->adjustmentComboBox->addItems(ADJUSTMENT);
+    QObject::connect(ui->adjustmentComboBox, SIGNAL(currentIndexChanged(int)), params, SLOT(setAdjustment(int)));
+    
+    /* Sparse pairwise tables */
+    QObject::connect(ui->sparseGroupBox, SIGNAL(toggled(bool)), params, SLOT(setSparse(bool)));
+    QObject::connect(ui->sparseSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setSparseThreshold(double)));
+    
+    /* Memory budget of pairwise tables */
+    QObject::connect(ui->memorySpinBox, SIGNAL(valueChanged(int)), params, SLOT(setMemoryBudget(int)));
+    
+    /* Prevalence sweep */
+    QObject::connect(ui->prevalenceGroupBox, SIGNAL(toggled(bool)), params, SLOT(setPrevalenceSweep(bool)));
+    QObject::connect(ui->prevalenceFromSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setPrevalenceFrom(double)));
+    QObject::connect(ui->prevalenceToSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setPrevalenceTo(double)));
+    QObject::connect(ui->prevalenceStepSpinBox, SIGNAL(valueChanged(double)), params, SLOT(setPrevalenceStep(double)));
+    
+    /* Jackknife */
+    ui->jackknifeComboBox->addItems(SORT_BY);
+    QObject::connect(ui->jackknifeGroupBox, SIGNAL(toggled(bool)), params, SLOT(setJackknife(bool)));
+    QObject::connect(ui->jackknifeComboBox, SIGNAL(currentIndexChanged(int)), params, SLOT(setJackknifeMeasure(int)));
+    QObject::connect(ui->influentialRowsSpinBox, SIGNAL(valueChanged(int)), params, SLOT(setInfluentialRows(int)));
         
     /* Calculator */
+    this->progress_bar = new QProgressBar(this);
+    this->progress_bar->setVisible(false);
+    ui->statusBar->addPermanentWidget(progress_bar);
+    
     QObject::connect(ui->actionCalculate, SIGNAL(triggered()), this, SLOT(calculate()));
-    QObject::connect(calculator, SIGNAL(calculated(bool)), ui->actionSave_Results, SLOT(setEnabled(bool)));
-    QObject::connect(calculator, SIGNAL(calculated(bool)), ui->resultsView, SLOT(reset()));
-    QObject::connect(calculator, SIGNAL(calculated(bool)), ui->resultsView, SLOT(resizeColumnsToContents()));
-    QObject::connect(calculator, SIGNAL(calculated(bool)), ui->actionCalculate, SLOT(setDisabled(bool)));
+    QObject::connect(ui->actionCancel, SIGNAL(triggered()), calculator, SLOT(cancel()));
+    QObject::connect(calculator, SIGNAL(progress(int,int)), this, SLOT(showProgress(int,int)));
+    QObject::connect(calculator, SIGNAL(rowsReady(int,int)), this, SLOT(showRows(int,int)));
+    QObject::connect(&calculation, SIGNAL(finished()), this, SLOT(calculationFinished()));
+    QObject::connect(&saving, SIGNAL(finished()), this, SLOT(saved()));
     
     /* Results */
     QObject::connect(ui->resultsComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(setResults(int)));
@@ -63,10 +102,22 @@ MainWindow::MainWindow(QWidget *parent) :
     QObject::connect(ui->sortGroupBox, SIGNAL(toggled(bool)), ui->sortComboBox, SLOT(setEnabled(bool)));
     QObject::connect(ui->sortGroupBox, SIGNAL(toggled(bool)), params, SLOT(setSorted(bool)));
     QObject::connect(ui->sortGroupBox, SIGNAL(toggled(bool)), this, SLOT(sortResults(bool)));
+    
+    /* Sort criteria */
+    QObject::connect(ui->sortComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->sortValueComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->sortOrderComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->thenComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->thenValueComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->thenOrderComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(rankResults()));
+    QObject::connect(ui->topSpinBox, SIGNAL(valueChanged(int)), this, SLOT(rankResults()));
 }
 
 MainWindow::~MainWindow()
 {
+    this->stopCalculating();
+    this->waitForSaving();
+    
     delete ui;
     
     delete params;
@@ -100,7 +151,18 @@ void MainWindow::on_actionOpen_triggered()
     
     int cols = data->columnCount();
     
-    if (cols==0 || cols==1)
+    if (!data->errorString().isEmpty())
+    {
+        QMessageBox msgBox;
+        msgBox.setText(data->errorString());
+        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.exec();
+        
+        this->clearData();
+        
+        return;
+    }
+    else if (cols==0 || cols==1)
     {
         QMessageBox msgBox;
         QString message = "Load at least 2 columns of data.";
@@ -131,6 +193,10 @@ void MainWindow::on_actionOpen_triggered()
     ui->GScomboBox->setEnabled(true);
     ui->GScomboBox->setCurrentIndex(0);
     
+    ui->referenceComboBox->addItem(tr("all pairs"));
+    ui->referenceComboBox->addItems(data->getHeader());
+    ui->referenceComboBox->setEnabled(true);
+    
     this->initResults();
     
     ui->actionCalculate->setEnabled(true);
@@ -145,91 +211,126 @@ void MainWindow::on_actionSave_Results_triggered()
         output_file.insert(i, "_out");
     }
     
-    QString filename = QFileDialog::getSaveFileName(this, tr("Save Results"), output_file, tr("Tab-delimited text file (*.txt)"));
+    QString columnar = tr("Columnar binary file (*.bdtc *.bdtc.gz)");
+    QString long_format = tr("Long-format text file (*.tsv *.tsv.gz)");
+    QString filter;
+    
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save Results"), output_file, tr("Tab-delimited text file (*.txt *.txt.gz)") + ";;" + long_format + ";;" + columnar, &filter);
     if (filename.isNull())
     {
         return;
     }
     
-    QFile file(filename);
-
-    if (file.open(QIODevice::WriteOnly))
+    // files named *.gz are compressed
+    QString name = filename;
+    
+    if (exporter::isCompressed(name))
     {
-        QTextStream output(&file);
-        
-        ResultsTable *res = NULL;
+        name.chop(3);
+    }
+    
+    save_file = filename;
+    save_format = TEXT_FORMAT;
+    save_pairs = exporter::Filter();
+    
+    if (filter==columnar || name.endsWith(".bdtc"))
+    {
+        save_format = COLUMNAR_FORMAT;
+    }
+    else if (filter==long_format || name.endsWith(".tsv"))
+    {
+        exporter::Filter pairs;
+        pairs.pvalue = ui->exportPvalueSpinBox->value();
         
-        int n = results->numberOfResults();
-        if (data->columnCount()==2)
-        {
-            n=1;
-        }
+        QStringList tests = results->confidence_intervals->verticalHeader();
+        QStringList names = ui->exportTestsLineEdit->text().split(",", QString::SkipEmptyParts);
         
-        for (int i=0; i<n; i++)
+        for (int k=0; k<names.length(); k++)
         {
-            if (i>0)
-            {
-                int id = results_map[i] - 1;
-                if (id%2==0)
-                {
-                    res = results->pc_pv[id/2];
-                }
-                else
-                {
-                    res = results->pc_ci[id/2];
-                }
-            }
-            else
-            {
-                res = results->confidence_intervals;
-            }
+            int test = tests.indexOf(names.at(k).trimmed());
             
-            output << results_list[i] << "\n";
-            for (int j=0; j<3; j++)
+            if (test<0)
             {
-                if (!res->info[j].isEmpty())
-                {
-                    output << res->info[j] << "\n";
-                }
+                QMessageBox::warning(this, tr("Save Results"), tr("There is no test %1.").arg(names.at(k).trimmed()));
+                return;
             }
             
-            int n_rows = res->rowCount();
-            int n_cols = res->columnCount();
-            
-            QStringList row;
-            row << "";
-            
-            for (int j=0; j<n_cols; j++)
-            {
-                row << res->headerData(j, Qt::Horizontal).toString();
-            }
-            
-            output << row.join("\t");
-            output << "\n";
-            
-            for (int j=0; j<n_rows; j++)
-            {
-                row.clear();
-                
-                row << res->headerData(j, Qt::Vertical).toString();
-                
-                for (int k=0; k<n_cols; k++)
-                {
-                    row << res->data(res->index(j, k), Qt::DisplayRole).toString();
-                }
-                
-                output << row.join("\t");
-                output << "\n";
-            }
-            output << "\n";
+            pairs.tests << test;
         }
         
-        file.close();
+        save_format = LONG_FORMAT;
+        save_pairs = pairs;
+    }
+    
+    // pairwise tables not calculated yet are calculated in another thread first, see calculationFinished()
+    QList<int> missing;
+    
+    for (int i=0; i<results_map.length(); i++)
+    {
+        if (!calculator->isCalculated(results_map[i]))
+        {
+            missing << results_map[i];
+        }
+    }
+    
+    if (!missing.isEmpty())
+    {
+        save_pending = true;
+        this->calculateTables(missing);
+        return;
+    }
+    
+    this->saveResults();
+}
+
+void MainWindow::saveResults()
+{
+    ui->actionSave_Results->setEnabled(false);
+    
+    // tables are saved in another thread, see waitForSaving()
+    switch (save_format)
+    {
+    case COLUMNAR_FORMAT:
+        saving.setFuture(QtConcurrent::run(exporter::saveColumnar, save_file, (const Results *)results));
+        break;
+    case LONG_FORMAT:
+        saving.setFuture(QtConcurrent::run(exporter::saveLong, save_file, (const Results *)results, save_pairs));
+        break;
+    default:
+        saving.setFuture(QtConcurrent::run(exporter::save, save_file, exporter::tables(results), false));
+        break;
+    }
+}
+
+void MainWindow::saved()
+{
+    ui->actionSave_Results->setEnabled(results!=NULL && results->areCalculated());
+    
+    if (!saving.result())
+    {
+        QMessageBox::warning(this, tr("Save Results"), tr("Results could not be saved."));
+    }
+}
+
+void MainWindow::waitForSaving()
+{
+    saving.waitForFinished();
+}
+
+void MainWindow::stopCalculating()
+{
+    if (calculation.isRunning())
+    {
+        calculator->cancel();
+        calculation.waitForFinished();
     }
 }
 
 void MainWindow::clearData()
 {
+    this->stopCalculating();
+    this->waitForSaving();
+    
     if (data!=NULL)
     {
         data->disconnect();
@@ -237,6 +338,8 @@ void MainWindow::clearData()
         ui->tableView->setModel(NULL);
         ui->GScomboBox->clear();
         ui->GScomboBox->setEnabled(false);
+        ui->referenceComboBox->clear();
+        ui->referenceComboBox->setEnabled(false);
         
         delete data;
         data = NULL;
@@ -245,19 +348,19 @@ void MainWindow::clearData()
 
 void MainWindow::setResults(int id)
 {
-    if (results!=NULL)
+    // only confidence intervals are shown while calculating, other tables when calculation finishes
+    if (results!=NULL && (!calculation.isRunning() || id==0))
     {
+        // pairwise tables are calculated in another thread when first chosen, they are shown when it finishes
+        if (id>0 && results->areCalculated() && !calculator->isCalculated(results_map[id]))
+        {
+            this->calculateTables(QList<int>() << results_map[id]);
+            return;
+        }
+        
         if (id>0)
         {
-            id = results_map[id] - 1;
-            if (id%2==0)
-            {
-                current_result = results->pc_pv[id/2];
-            }
-            else
-            {
-                current_result = results->pc_ci[id/2];
-            }
+            current_result = results->table(results_map[id]);
         }
         else
         {
@@ -270,11 +373,15 @@ void MainWindow::setResults(int id)
         ui->infoLabel1->setText(current_result->info[0]);
         ui->infoLabel2->setText(current_result->info[1]);
         ui->infoLabel3->setText(current_result->info[2]);
+        ui->infoLabel4->setText(current_result->info[3]);
     }
 }
 
 void MainWindow::clearResults()
 {
+    this->stopCalculating();
+    this->waitForSaving();
+    
     if (results!=NULL)
     {
         ui->resultsView->setModel(NULL);
@@ -287,9 +394,14 @@ void MainWindow::clearResults()
         
         results = new Results(data, params);
         
-        if (ui->resultsComboBox->count()==0)
+        // optional tables may have been switched on or off
+        int current = ui->resultsComboBox->currentIndex();
+        
+        this->mapResults();
+        
+        if (current>0 && current<ui->resultsComboBox->count())
         {
-            this->mapResults();
+            ui->resultsComboBox->setCurrentIndex(current);
         }
         
         calculator->setResults(results);
@@ -297,17 +409,19 @@ void MainWindow::clearResults()
         ui->infoLabel1->setText("");
         ui->infoLabel2->setText("");
         ui->infoLabel3->setText("");
+        ui->infoLabel4->setText("");
         
         ui->actionCalculate->setEnabled(true);
         
-        /* Sort criteria */
-        QObject::connect(ui->sortComboBox, SIGNAL(currentIndexChanged(int)), results, SLOT(sortBy(int)));
-        QObject::connect(results, SIGNAL(resultsChanged()), this, SLOT(updateResults()));
+        QObject::connect(results, SIGNAL(resultsChanged()), this, SLOT(reorderResults()));
     }
 }
 
 void MainWindow::initResults()
 {
+    this->stopCalculating();
+    this->waitForSaving();
+    
     if (results!=NULL)
     {
         ui->resultsView->setModel(NULL);
@@ -326,38 +440,39 @@ void MainWindow::initResults()
     
     ui->actionCalculate->setEnabled(true);
     
-    /* Sort criteria */
-    QObject::connect(ui->sortComboBox, SIGNAL(currentIndexChanged(int)), results, SLOT(sortBy(int)));
-    QObject::connect(results, SIGNAL(resultsChanged()), this, SLOT(updateResults()));
+    QObject::connect(results, SIGNAL(resultsChanged()), this, SLOT(reorderResults()));
 }
 
 void MainWindow::mapResults()
 {
     ui->resultsComboBox->clear();
-    ui->resultsComboBox->addItem(RESULTS[0]);
-    results_list[0] = RESULTS[0];
-    results_map[0] = 0;
     
-    int r = 1;
-    for (int i=1; i<NRESTOT; i++)
+    results_list.clear();
+    results_map.clear();
+    
+    for (int i=0; i<NTABLES; i++)
     {
-        int id = i - 1;
-        if (results->toCalculate(id/2))
+        if (results->hasTable(i))
         {
-            results_list[r] = RESULTS[i];
+            results_list << RESULTS[i];
             ui->resultsComboBox->addItem(RESULTS[i]);
-            results_map[r] = i;
-            r++;
+            results_map << i;
         }
     }
     
     ui->sortComboBox->clear();
+    ui->thenComboBox->clear();
+    ui->thenComboBox->addItem("-");
+    
+    sort_map.clear();
     
     for (int i=0; i<NRESULTS; i++)
     {
         if (results->toCalculate(i))
         {
+            sort_map << i;
             ui->sortComboBox->addItem(SORT_BY[i]);
+            ui->thenComboBox->addItem(SORT_BY[i]);
         }
     }
 }
@@ -370,14 +485,43 @@ void MainWindow::updateResults()
     }
 }
 
+void MainWindow::reorderResults()
+{
+    if (current_result!=NULL)
+    {
+        current_result->updateOrder();
+    }
+}
+
 void MainWindow::sortResults(bool enabled)
 {
+    this->waitForSaving();
+    
     if (results!=NULL && results->areCalculated())
     {
         if (enabled)
         {
-            int column = ui->sortComboBox->currentIndex();
-            results->sortBy(column);
+            QList<RankKey> keys;
+            RankKey key;
+            
+            // items of order combo boxes are ASCENDING and DESCENDING
+            key.column = ui->sortComboBox->currentIndex();
+            key.which = ui->sortValueComboBox->currentIndex();
+            key.order = ui->sortOrderComboBox->currentIndex();
+            keys << key;
+            
+            // first item of the second criterion is none
+            key.column = ui->thenComboBox->currentIndex() - 1;
+            key.which = ui->thenValueComboBox->currentIndex();
+            key.order = ui->thenOrderComboBox->currentIndex();
+            if (key.column>=0)
+            {
+                keys << key;
+            }
+            
+            int top = ui->topSpinBox->value();
+            
+            results->rank(keys, top>0 ? top : -1);
         }
         else
         {
@@ -386,6 +530,33 @@ void MainWindow::sortResults(bool enabled)
     }
 }
 
+void MainWindow::rankResults()
+{
+    this->sortResults(ui->sortGroupBox->isChecked());
+}
+
+int MainWindow::defaultOrder(int index) const
+{
+    // tests with low likelihood ratio of a negative test are the best ones
+    if (index>=0 && index<sort_map.size() && sort_map.at(index)==LRN)
+    {
+        return ASCENDING;
+    }
+    
+    return DESCENDING;
+}
+
+void MainWindow::on_sortComboBox_currentIndexChanged(int index)
+{
+    ui->sortOrderComboBox->setCurrentIndex(defaultOrder(index));
+}
+
+void MainWindow::on_thenComboBox_currentIndexChanged(int index)
+{
+    // first item is none
+    ui->thenOrderComboBox->setCurrentIndex(defaultOrder(index - 1));
+}
+
 void MainWindow::caseToCalculate(int gs)
 {
     if (gs==-1)
@@ -393,62 +564,167 @@ void MainWindow::caseToCalculate(int gs)
         return;
     }
     
-    bool senonly = true;
-    bool speonly = true;
+    params->setCaseToCalculate(Results::caseToCalculate(BinaryData::fromDataTable(data), gs));
+}
+
+void MainWindow::on_referenceComboBox_currentIndexChanged(int index)
+{
+    // the first item compares all pairs
+    params->setReference(qMax(index - 1, -1));
+}
+
+void MainWindow::calculate()
+{   
+    this->waitForSaving();
     
-    int n_rows = data->rowCount();
+    ui->tabWidget->setCurrentIndex(1);
+    
+    // tables are written by another thread, only rows of confidence intervals calculated so far are shown
+    ui->resultsView->setModel(NULL);
+    current_result = NULL;
+    
+    ui->actionCalculate->setEnabled(false);
+    ui->actionCancel->setEnabled(true);
+    
+    progress_bar->setValue(0);
+    progress_bar->setVisible(true);
     
-    for (int i=0; i<n_rows; i++)
+    calculation.setFuture(calculator->start());
+    
+    if (ui->resultsComboBox->currentIndex()!=0)
     {
-        if (!data->isActive(i))
-        {
-            continue;
-        }
-        
-        if (data->row(i).at(gs)!="1")
-        {
-            senonly = false;
-            break;
-        }
+        ui->resultsComboBox->setCurrentIndex(0);
     }
+    else
+    {
+        this->setResults(0);
+    }
+}
+
+void MainWindow::calculateTables(const QList<int> &ids)
+{
+    ui->actionSave_Results->setEnabled(false);
+    ui->actionCancel->setEnabled(true);
+    
+    progress_bar->setValue(0);
+    progress_bar->setVisible(true);
+    
+    calculation.setFuture(calculator->startTables(ids));
+}
+
+void MainWindow::calculationFinished()
+{
+    ui->actionCancel->setEnabled(false);
+    progress_bar->setVisible(false);
     
-    if (senonly)
+    // results waiting for their missing tables are not saved if calculation was cancelled
+    bool save = save_pending && !calculator->isCancelled();
+    save_pending = false;
+    
+    if (results==NULL)
     {
-        params->setCaseToCalculate(SENONLY);
         return;
     }
     
-    for (int i=0; i<n_rows; i++)
+    // results of cancelled calculation are incomplete
+    if (!results->areCalculated())
     {
-        if (!data->isActive(i))
-        {
-            continue;
-        }
-        
-        if (data->row(i).at(gs)!="0")
-        {
-            speonly = false;
-            break;
-        }
+        this->clearResults();
+        this->setResults(ui->resultsComboBox->currentIndex());
+        return;
     }
     
-    if(speonly)
+    ui->actionSave_Results->setEnabled(true);
+    
+    results->confidence_intervals->showRows(-1);
+    
+    this->sortResults(params->isSorted());
+    
+    if (save)
+    {
+        this->saveResults();
+    }
+    
+    int id = ui->resultsComboBox->currentIndex();
+    
+    // cancelled table is calculated again only when it is chosen again
+    if (calculator->isCancelled() && id>0 && !calculator->isCalculated(results_map[id]))
     {
-        params->setCaseToCalculate(SPEONLY);
+        ui->resultsComboBox->setCurrentIndex(0);
         return;
     }
     
-    params->setCaseToCalculate(ALL);
-    return;
+    this->setResults(id);
 }
 
-void MainWindow::calculate()
-{   
-    calculator->calculate();
+void MainWindow::showRows(int id, int rows)
+{
+    if (results!=NULL)
+    {
+        results->table(id)->showRows(rows);
+        ui->resultsView->resizeColumnsToContents();
+    }
+}
+
+void MainWindow::showProgress(int done, int total)
+{
+    progress_bar->setMaximum(total);
+    progress_bar->setValue(done);
+}
+
+void MainWindow::on_actionSimulate_triggered()
+{
+    Scenario scenario;
     
-    ui->tabWidget->setCurrentIndex(1);
-    this->sortResults(params->isSorted());
-    this->setResults(ui->resultsComboBox->currentIndex());
+    scenario.subjects = 200;
+    scenario.prevalence = 0.3;
+    scenario.correlation = 0.3;
+    
+    if (data!=NULL)
+    {
+        // start from the design of the loaded study
+        BinaryData bits = BinaryData::fromDataTable(data);
+        
+        int gc = params->getGoldStandard();
+        int n = bits.rowCount();
+        int positives = bits.count(gc);
+        int negatives = n - positives;
+        
+        QStringList header = data->getHeader();
+        
+        scenario.subjects = qMax(n, 10);
+        if (positives>0 && negatives>0)
+        {
+            scenario.prevalence = (double)positives / n;
+        }
+        
+        for (int j=0; j<bits.columnCount(); j++)
+        {
+            if (j==gc)
+            {
+                continue;
+            }
+            
+            int a = bits.countBoth(gc, j);
+            int b = bits.count(j) - a;
+            
+            scenario.names << header.at(j);
+            scenario.sensitivity << (positives>0 ? (double)a / positives : 0.8);
+            scenario.specificity << (negatives>0 ? (double)(negatives - b) / negatives : 0.8);
+        }
+    }
+    else
+    {
+        for (int k=0; k<3; k++)
+        {
+            scenario.names << "Test " + QString::number(k + 1);
+            scenario.sensitivity << 0.8;
+            scenario.specificity << 0.8;
+        }
+    }
+    
+    simulation_dialog->setScenario(scenario);
+    simulation_dialog->show();
 }
 
 void MainWindow::on_actionAbout_triggered()
@@ -22,34 +22,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMainWindow>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 
 #include <aboutdialog.hpp>
+#include <simulationdialog.hpp>
 
 #include "params.hpp"
 #include "datatable.hpp"
 #include "results.hpp"
 #include "resultstable.hpp"
 #include "calculator.hpp"
-
-const QStringList RESULTS = (QStringList()
-                             << "Performance measures (point estimates and confidence intervals)"
-                             << "Pairwise accuracy p-value"
-                             << "Pairwise accuracy confidence intervals"
-                             << "Pairwise sensitivity p-value"
-                             << "Pairwise sensitivity confidence intervals"
-                             << "Pairwise specificity p-value"
-                             << "Pairwise specificity confidence intervals"
-                             << "Positive Predictive Value p-value"
-                             << "Positive Predictive Value confidence intervals"
-                             << "Negative Predictive Value p-value"
-                             << "Negative Predictive Value confidence intervals"
-                             << "Likelihood ratio of a positive test p-value"
-                             << "Likelihood ratio of a positive test confidence intervals"
-                             << "Likelihood ratio of a negative test p-value"
-                             << "Likelihood ratio of a negative test confidence intervals");
+#include "adjustment.hpp"
+#include "exporter.hpp"
 
 const QStringList SORT_BY = (QStringList() << "Acc" << "Se" << "Sp" << "PPV" << "NPV" << "DLR(+)" << "DLR(-)");
 
+//! formats of saved results
+const int TEXT_FORMAT     = 0;
+const int LONG_FORMAT     = 1;
+const int COLUMNAR_FORMAT = 2;
+
 namespace Ui {
     class MainWindow;
 }
@@ -65,6 +59,7 @@ public:
 private slots:
     void on_actionOpen_triggered();
     void on_actionSave_Results_triggered();
+    void saved();
     
     void clearData();
     
@@ -73,32 +68,78 @@ private slots:
     void initResults();
     void mapResults();
     void updateResults();
+    //! shows tests in new order, only the best ones with a limit of sorting
+    void reorderResults();
     void sortResults(bool enabled);
+    //! sorts results again after criteria changed
+    void rankResults();
+    //! sets default order of the measure chosen as a criterion
+    void on_sortComboBox_currentIndexChanged(int index);
+    void on_thenComboBox_currentIndexChanged(int index);
     
     void caseToCalculate(int gs);
+    void on_referenceComboBox_currentIndexChanged(int index);
     
     void calculate();
+    void calculationFinished();
+    void showProgress(int done, int total);
+    //! shows rows of table id calculated by another thread so far
+    void showRows(int id, int rows);
     
+    void on_actionSimulate_triggered();
     void on_actionAbout_triggered();
 
 private:
+    //! tables being saved must not be changed or deleted, so changes wait until saving finishes
+    void waitForSaving();
+    
+    //! saves results as chosen last time in another thread, their tables must be calculated
+    void saveResults();
+    
+    //! results must not be changed or deleted while calculating, so calculation is cancelled first
+    void stopCalculating();
+    
+    //! calculates missing tables of results with given ids in another thread, see calculationFinished()
+    void calculateTables(const QList<int> &ids);
+    
+    //! returns order (ASCENDING or DESCENDING) in which the best tests come first for item index of sort combo box
+    int defaultOrder(int index) const;
+    
     Ui::MainWindow *ui;
 
     AboutDialog dialog;
+    SimulationDialog *simulation_dialog;
     
     Params *params;
     
     QString input_file;
     QString output_file;
     
-    QString results_list[NRESTOT];
-    int results_map[NRESTOT];
+    //! names and ids (see Results::table()) of tables in results combo box
+    QStringList results_list;
+    QList<int> results_map;
+    
+    //! measures (ACC ... LRN) of items of sort combo boxes
+    QList<int> sort_map;
     
     DataTable *data;
     Results *results;
     ResultsTable *current_result;
     Calculator *calculator;
     
+    //! file, format and filter of pairs (long format only) of results to save
+    QString save_file;
+    int save_format;
+    exporter::Filter save_pairs;
+    
+    //! results are saved when calculation of their missing tables finishes
+    bool save_pending;
+    
+    QFutureWatcher<bool> saving;
+    QFutureWatcher<void> calculation;
+    
+    QProgressBar *progress_bar;
+    
 };
 
 #endif // MAINWINDOW_H
@@ -22,9 +22,30 @@ Params::Params(QObject *parent) :
     QObject(parent)
 {
     gold_standard = 0;
+    reference = -1;
     case_to_calculate = ALL;
     confidence_level = 0.95;
     pvalue = 0.05;
+    threshold = 0.05;
+    
+    pairwise_test = ASYMPTOTIC;
+    permutations = 100000;
+    
+    adjustment = NOADJUSTMENT;
+    
+    prevalence_sweep = false;
+    prevalence_from = 0.01;
+    prevalence_to = 0.5;
+    prevalence_step = 0.01;
+    
+    sparse = false;
+    sparse_threshold = 0.1;
+    
+    memory_budget = 2048;
+    
+    jackknife = false;
+    jackknife_measure = 0;
+    influential_rows = 20;
     
     sorted = false;
 }
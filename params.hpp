@@ -20,22 +20,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PARAMS_HPP
 
 #include <QObject>
+#include <QStringList>
+#include <QVector>
 
 const int ALL     = 0;
 const int SENONLY = 1;
 const int SPEONLY = 2;
 
+const int ASYMPTOTIC  = 0;
+const int PERMUTATION = 1;
+
+const int NOADJUSTMENT = 0;
+const int HOLM         = 1;
+const int HOCHBERG     = 2;
+const int BH           = 3;
+
 class Params : public QObject
 {
     Q_OBJECT
     
     int gold_standard;
+    int reference;
     int case_to_calculate;
     double confidence_level;
     double pvalue;
+    double threshold;
+    
+    int pairwise_test;
+    int permutations;
+    
+    int adjustment;
+    
+    bool prevalence_sweep;
+    double prevalence_from;
+    double prevalence_to;
+    double prevalence_step;
+    
+    bool sparse;
+    double sparse_threshold;
+    
+    int memory_budget;
+    
+    bool jackknife;
+    int jackknife_measure;
+    int influential_rows;
     
     bool sorted;
     
+    QStringList strata;
+    
 public:
     explicit Params(QObject *parent = 0);
     
@@ -44,6 +77,12 @@ public:
         return gold_standard;
     }
     
+    //! returns column compared with all other tests or -1 if all pairs are compared
+    int getReference() const
+    {
+        return reference;
+    }
+    
     double getConfidenceLevel() const
     {
         return confidence_level;
@@ -54,16 +93,141 @@ public:
         return pvalue;
     }
     
+    //! returns p-value below which pairwise comparisons are highlighted
+    double getThreshold() const
+    {
+        return threshold;
+    }
+    
     int getCaseToCalculate() const
     {
         return case_to_calculate;
     }
     
+    //! returns ASYMPTOTIC or PERMUTATION
+    int getPairwiseTest() const
+    {
+        return pairwise_test;
+    }
+    
+    //! returns maximal number of Monte Carlo permutations
+    int getPermutations() const
+    {
+        return permutations;
+    }
+    
+    //! returns method of multiple comparison adjustment of pairwise p-values
+    int getAdjustment() const
+    {
+        return adjustment;
+    }
+    
+    bool isPrevalenceSweep() const
+    {
+        return prevalence_sweep;
+    }
+    
+    //! returns prevalences for which predictive values are calculated
+    QVector<double> getPrevalenceGrid() const
+    {
+        QVector<double> grid;
+        
+        int n = (int)((prevalence_to - prevalence_from) / prevalence_step + 1e-9);
+        
+        for (int k=0; k<=n; k++)
+        {
+            grid.append(prevalence_from + k * prevalence_step);
+        }
+        
+        return grid;
+    }
+    
+    //! are pairwise tables stored sparse
+    bool isSparse() const
+    {
+        return sparse;
+    }
+    
+    //! returns p-value below which pairs are stored in sparse tables
+    double getSparseThreshold() const
+    {
+        return sparse_threshold;
+    }
+    
+    //! returns size (MB) of dense pairwise tables kept on the heap, 0 if unlimited
+    int getMemoryBudget() const
+    {
+        return memory_budget;
+    }
+    
+    bool isJackknife() const
+    {
+        return jackknife;
+    }
+    
+    //! returns measure (ACC ... LRN) of pairwise jackknife statistics and influence on pairwise differences
+    int getJackknifeMeasure() const
+    {
+        return jackknife_measure;
+    }
+    
+    //! returns number of most influential rows to report
+    int getInfluentialRows() const
+    {
+        return influential_rows;
+    }
+    
     void setCaseToCalculate(int c)
     {
         this->case_to_calculate = c;
     }
     
+    void setPermutations(int permutations)
+    {
+        this->permutations = permutations;
+    }
+    
+    /*!
+      returns names or numbers (from 1) of stratum columns, they may hold
+      any values and are not tests, results are calculated for every group
+      of rows with the same values of them
+    */
+    QStringList getStrata() const
+    {
+        return strata;
+    }
+    
+    void setStrata(const QStringList &strata)
+    {
+        this->strata = strata;
+    }
+    
+    //! copies all settings of other without emitting any signals
+    void assign(const Params *other)
+    {
+        gold_standard = other->gold_standard;
+        reference = other->reference;
+        case_to_calculate = other->case_to_calculate;
+        confidence_level = other->confidence_level;
+        pvalue = other->pvalue;
+        threshold = other->threshold;
+        pairwise_test = other->pairwise_test;
+        permutations = other->permutations;
+        adjustment = other->adjustment;
+        prevalence_sweep = other->prevalence_sweep;
+        prevalence_from = other->prevalence_from;
+        prevalence_to = other->prevalence_to;
+        prevalence_step = other->prevalence_step;
+        sparse = other->sparse;
+        sparse_threshold = other->sparse_threshold;
+        memory_budget = other->memory_budget;
+        jackknife = other->jackknife;
+        jackknife_measure = other->jackknife_measure;
+        influential_rows = other->influential_rows;
+        sorted = other->sorted;
+        strata = other->strata;
+    }
+    
     bool isSorted() const
     {
         return sorted;
@@ -72,6 +236,7 @@ public:
 signals:
     void paramsChanged();
     void gsChanged(int gs);
+    void thresholdChanged();
     
 public slots:
     void setGoldStandard(int gs)
@@ -82,6 +247,13 @@ public slots:
         emit paramsChanged();
     }
     
+    void setReference(int column)
+    {
+        reference = column;
+        
+        emit paramsChanged();
+    }
+    
     void setConfidenceLevel(double cl)
     {
         confidence_level = cl;
@@ -96,6 +268,98 @@ public slots:
         emit paramsChanged();
     }
     
+    //! only views are updated, results are not recalculated
+    void setThreshold(double threshold)
+    {
+        this->threshold = threshold;
+        
+        emit thresholdChanged();
+    }
+    
+    void setPermutationTest(bool enabled)
+    {
+        pairwise_test = enabled ? PERMUTATION : ASYMPTOTIC;
+        
+        emit paramsChanged();
+    }
+    
+    void setAdjustment(int method)
+    {
+        adjustment = method;
+        
+        emit paramsChanged();
+    }
+    
+    void setPrevalenceSweep(bool enabled)
+    {
+        prevalence_sweep = enabled;
+        
+        emit paramsChanged();
+    }
+    
+    void setPrevalenceFrom(double prevalence)
+    {
+        prevalence_from = prevalence;
+        
+        emit paramsChanged();
+    }
+    
+    void setPrevalenceTo(double prevalence)
+    {
+        prevalence_to = prevalence;
+        
+        emit paramsChanged();
+    }
+    
+    void setPrevalenceStep(double step)
+    {
+        prevalence_step = step;
+        
+        emit paramsChanged();
+    }
+    
+    void setSparse(bool enabled)
+    {
+        sparse = enabled;
+        
+        emit paramsChanged();
+    }
+    
+    void setSparseThreshold(double threshold)
+    {
+        sparse_threshold = threshold;
+        
+        emit paramsChanged();
+    }
+    
+    void setMemoryBudget(int megabytes)
+    {
+        memory_budget = megabytes;
+        
+        emit paramsChanged();
+    }
+    
+    void setJackknife(bool enabled)
+    {
+        jackknife = enabled;
+        
+        emit paramsChanged();
+    }
+    
+    void setJackknifeMeasure(int measure)
+    {
+        jackknife_measure = measure;
+        
+        emit paramsChanged();
+    }
+    
+    void setInfluentialRows(int rows)
+    {
+        influential_rows = rows;
+        
+        emit paramsChanged();
+    }
+    
     void setSorted(bool sorted)
     {
         this->sorted = sorted;
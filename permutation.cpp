@@ -1,15 +1,8 @@
 #include "permutation.hpp"
 
-//! returns whether pair p1 is less than pair p2
-bool permutation::pairLessThan(const pair &p1, const pair &p2)
+permutation::KeysLessThan::KeysLessThan(const QVector<Key> *keys)
 {
-    return p1.value < p2.value;
-}
-
-//! returns whether pair p1 is greater than pair p2
-bool permutation::pairGreaterThan(const pair &p1, const pair &p2)
-{
-    return p1.value > p2.value;
+    this->keys = keys;
 }
 
 Permutation::Permutation(int length)
@@ -17,12 +10,6 @@ Permutation::Permutation(int length)
     this->length = length;
     
     // initial permutation
-    for (int i=0; i<length; i++)
-    {
-        permutation::pair p;
-        
-        p.index = i;
-        
-        list.append(p);
-    }
+    order.resize(length);
+    resetToIdentity();
 }
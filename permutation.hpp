@@ -1,22 +1,55 @@
 #ifndef PERMUTATION_HPP
 #define PERMUTATION_HPP
 
-#include <QList>
-#include <QtAlgorithms>
+#include <QVector>
+
+#include <algorithm>
 
 const int ASCENDING  = 0;
 const int DESCENDING = 1;
 
 namespace permutation
 {
-    struct pair
+    //! sort key: value of position i is values[i * stride]
+    struct Key
     {
-        double value;
-        int index;
+        const double *values;
+        int stride;
+        int order;
     };
     
-    bool pairLessThan(const pair &p1, const pair &p2);
-    bool pairGreaterThan(const pair &p1, const pair &p2);
+    //! compares positions by keys one after another, NaNs go last and ties keep positions in order
+    struct KeysLessThan
+    {
+        KeysLessThan(const QVector<Key> *keys);
+        
+        bool operator()(int x, int y) const
+        {
+            for (int k=0; k<keys->size(); k++)
+            {
+                const Key &key = keys->at(k);
+                
+                double a = key.values[x * key.stride];
+                double b = key.values[y * key.stride];
+                
+                if (a==b || (a!=a && b!=b))
+                {
+                    continue;
+                }
+                
+                if (a!=a || b!=b)
+                {
+                    return b!=b;
+                }
+                
+                return key.order==DESCENDING ? a > b : a < b;
+            }
+            
+            return x < y;
+        }
+        
+        const QVector<Key> *keys;
+    };
 }
 
 class Permutation
@@ -29,7 +62,7 @@ public:
     {
         if (x<length)
         {
-            return list.at(x).index;
+            return order.at(x);
         }
         else
         {
@@ -37,22 +70,35 @@ public:
         }
     }
     
-    //! sorts the list of values and builds permutation
-    void sort(QList<double> *value, int order=DESCENDING)
+    //! number of first positions shown in views, see sort()
+    int shownCount() const
     {
-        for (int i=0; i<length; i++)
+        return shown;
+    }
+    
+    /*!
+      sorts positions by keys, first key decides and next ones break ties;
+      if top is not negative only the first top positions are sorted and
+      shown, the rest follow in their original order
+    */
+    void sort(const QVector<permutation::Key> &keys, int top=-1)
+    {
+        resetToIdentity();
+        
+        permutation::KeysLessThan less(&keys);
+        
+        if (top>=0 && top<length)
         {
-            list[i].value = value->at(i);
-            list[i].index = i;
+            std::partial_sort(order.begin(), order.begin() + top, order.end(), less);
+            
+            // the rest keep their original order
+            std::sort(order.begin() + top, order.end());
+            
+            shown = top;
         }
-        
-        switch (order)
+        else
         {
-        case DESCENDING:
-            qSort(list.begin(), list.end(), permutation::pairGreaterThan);
-            break;
-        case ASCENDING:
-            qSort(list.begin(), list.end(), permutation::pairLessThan);
+            std::sort(order.begin(), order.end(), less);
         }
     }
     
@@ -60,16 +106,21 @@ public:
     {
         for (int i=0; i<length; i++)
         {
-            list[i].index = i;
+            order[i] = i;
         }
+        
+        shown = length;
     }
     
 private:
     //!length of permutation
     int length;
        
-    //! list of pairs
-    QList<permutation::pair> list;
+    //! positions in current order
+    QVector<int> order;
+    
+    //! number of positions shown
+    int shown;
 };
 
 #endif // PERMUTATION_HPP
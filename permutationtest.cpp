@@ -0,0 +1,214 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "permutationtest.hpp"
+
+#include <QtConcurrentMap>
+
+#include <boost/math/distributions/binomial.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+//! number of permutations done by one thread between checks of stopping rule
+const int BATCH_SIZE = 1000;
+
+//! number of batches between checks of stopping rule, fixed so results do not depend on the machine
+const int BATCHES_PER_ROUND = 8;
+
+double permutationtest::mcnemar(double b, double c)
+{
+    double n = b + c;
+
+    if (n<1.0)
+    {
+        return 1.0;
+    }
+
+    // under null hypothesis every discordant pair is swapped with probability 1/2
+    boost::math::binomial binomial(n, 0.5);
+
+    double pvalue = 2.0 * boost::math::cdf(binomial, qMin(b, c));
+
+    if (pvalue>1.0)
+    {
+        pvalue = 1.0;
+    }
+
+    return pvalue;
+}
+
+permutationtest::CochranBatch::CochranBatch(const QVector<int> *row_sums, int m, int offset, double observed, int size)
+{
+    this->row_sums = row_sums;
+    this->m = m;
+    this->offset = offset;
+    this->observed = observed;
+    this->size = size;
+}
+
+int permutationtest::CochranBatch::operator()(const int &seed) const
+{
+    boost::random::mt19937 generator(seed);
+
+    QVector<int> index(m);
+    QVector<int> col_sums(m);
+
+    for (int j=0; j<m; j++)
+    {
+        index[j] = j;
+    }
+
+    int n_rows = row_sums->size();
+    int hits = 0;
+
+    for (int p=0; p<size; p++)
+    {
+        int base = offset;
+
+        col_sums.fill(0);
+
+        for (int i=0; i<n_rows; i++)
+        {
+            int k = row_sums->at(i);
+            int step = 1;
+
+            // it is cheaper to scatter zeros when most of the row are ones
+            if (2*k>m)
+            {
+                k = m - k;
+                step = -1;
+                base++;
+            }
+
+            // partial Fisher-Yates shuffle, index stays a permutation between rows
+            for (int l=0; l<k; l++)
+            {
+                boost::random::uniform_int_distribution<int> pick(l, m-1);
+
+                qSwap(index[l], index[pick(generator)]);
+
+                col_sums[index[l]] += step;
+            }
+        }
+
+        double statistic = 0.0;
+
+        for (int j=0; j<m; j++)
+        {
+            double col_sum = col_sums[j] + base;
+            statistic += col_sum * col_sum;
+        }
+
+        if (statistic >= observed - 1e-9)
+        {
+            hits++;
+        }
+    }
+
+    return hits;
+}
+
+permutationtest::result permutationtest::cochranQ(const QVector<int> &row_sums, int m, double observed, double alpha, int max_permutations)
+{
+    result output;
+
+    // rows of only zeros or only ones are the same in every permutation
+    QVector<int> informative;
+    int offset = 0;
+
+    for (int i=0; i<row_sums.size(); i++)
+    {
+        int r = row_sums.at(i);
+
+        if (r==m)
+        {
+            offset++;
+        }
+        else if (r>0)
+        {
+            informative.append(r);
+        }
+    }
+
+    if (informative.isEmpty())
+    {
+        output.pvalue = 1.0;
+        output.permutations = 0;
+
+        return output;
+    }
+
+    CochranBatch batch(&informative, m, offset, observed, BATCH_SIZE);
+
+    boost::math::normal normal;
+
+    double z = boost::math::quantile(normal, 0.995);
+
+    int performed = 0;
+    int hits = 0;
+    int round = 0;
+
+    double pvalue = 1.0;
+
+    while (performed<max_permutations)
+    {
+        // the last round is cut to max_permutations, its last batch may be smaller
+        int remaining = qMin(max_permutations - performed, BATCHES_PER_ROUND * BATCH_SIZE);
+        int batches = remaining / BATCH_SIZE;
+        int rest = remaining % BATCH_SIZE;
+
+        // seeds depend only on round and batch, so result does not depend on scheduling
+        QList<int> seeds;
+        for (int t=0; t<batches; t++)
+        {
+            seeds << round * BATCHES_PER_ROUND + t + 1;
+        }
+
+        QList<int> counts = QtConcurrent::blockingMapped(seeds, batch);
+
+        for (int t=0; t<counts.length(); t++)
+        {
+            hits += counts.at(t);
+        }
+
+        if (rest>0)
+        {
+            CochranBatch last(&informative, m, offset, observed, rest);
+
+            hits += last(round * BATCHES_PER_ROUND + batches + 1);
+        }
+
+        performed += remaining;
+        round++;
+
+        pvalue = (hits + 1.0) / (performed + 1.0);
+
+        double std_err = sqrt(pvalue * (1.0 - pvalue) / performed);
+
+        if (pvalue - z * std_err > alpha || pvalue + z * std_err < alpha)
+        {
+            break;
+        }
+    }
+
+    output.pvalue = pvalue;
+    output.permutations = performed;
+
+    return output;
+}
@@ -0,0 +1,65 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PERMUTATIONTEST_HPP
+#define PERMUTATIONTEST_HPP
+
+#include <QList>
+#include <QVector>
+
+namespace permutationtest
+{
+    //! exact McNemar p-value for b and c discordant pairs
+    double mcnemar(double b, double c);
+
+    //! Monte Carlo result of Cochran's Q permutation test
+    struct result
+    {
+        double pvalue;
+        int permutations;
+    };
+
+    //! one batch of random within-row permutations of Cochran's Q
+    struct CochranBatch
+    {
+        typedef int result_type;
+
+        CochranBatch(const QVector<int> *row_sums, int m, int offset, double observed, int size);
+
+        //! returns number of permutations with statistic not less than observed one
+        int operator()(const int &seed) const;
+
+        //! row sums of rows with both zeros and ones
+        const QVector<int> *row_sums;
+        int m;
+        //! number of rows with only ones
+        int offset;
+        double observed;
+        int size;
+    };
+
+    /*!
+      Monte Carlo Cochran's Q test. Rows are permuted independently (which
+      keeps row sums) and only sum of squared column sums varies, so it is
+      used as test statistic. Sampling stops as soon as confidence interval
+      of estimated p-value does not contain alpha.
+    */
+    result cochranQ(const QVector<int> &row_sums, int m, double observed, double alpha, int max_permutations);
+}
+
+#endif // PERMUTATIONTEST_HPP
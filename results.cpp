@@ -17,6 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "results.hpp"
+#include "adjustment.hpp"
+
+#include <QtConcurrentMap>
 
 Results::Results(DataTable *data, Params *params, QObject *parent) :
     QObject(parent)
@@ -24,11 +27,48 @@ Results::Results(DataTable *data, Params *params, QObject *parent) :
     this->data = data;
     this->params = params;
     
+    init(data->getHeader());
+}
+
+Results::Results(const QStringList &header, Params *params, QObject *parent) :
+    QObject(parent)
+{
+    this->data = NULL;
+    this->params = params;
+    
+    init(header);
+}
+
+int Results::caseToCalculate(const BinaryData &bits, int gc)
+{
+    int positive = bits.count(gc);
+    
+    if (positive==bits.rowCount())
+    {
+        return SENONLY;
+    }
+    
+    if (positive==0)
+    {
+        return SPEONLY;
+    }
+    
+    return ALL;
+}
+
+void Results::init(const QStringList &header)
+{
     // initialize permutation of tests
-    permutation = new Permutation(data->numberOfTests());
+    permutation = new Permutation(header.length() - 1);
     
     this->calculated = false;
     
+    for (int i=0; i<NRESULTS; i++)
+    {
+        pairwise_calculated[i] = false;
+        pairwise_adjusted[i] = false;
+    }
+    
     switch (params->getCaseToCalculate())
     {
     case ALL:
@@ -56,38 +96,123 @@ Results::Results(DataTable *data, Params *params, QObject *parent) :
         break;
     }
     
-    QStringList header;
+    QStringList measures;
     for (int i=0; i<NRESULTS; i++)
     {
         if (available_results[i])
         {
-            header << HEADER[i];
+            measures << HEADER[i];
         }
     }
     
     confidence_intervals = new ResultsTable(permutation, true);
-    confidence_intervals->setHorizontalHeader(header);
+    confidence_intervals->setHorizontalHeader(measures);
+    
+    QStringList tests = header;
+    tests.removeAt(params->getGoldStandard());
+    
+    confidence_intervals->setVerticalHeader(tests);
+    
+    reference = params->getReference();
+    
+    if (reference==params->getGoldStandard() || reference>=header.length())
+    {
+        reference = -1;
+    }
+    
+    reference_test = reference;
+    
+    if (reference>params->getGoldStandard())
+    {
+        reference_test--;
+    }
     
-    header = data->getHeader();
-    header.removeAt(params->getGoldStandard());
+    QStringList compared = tests;
     
-    confidence_intervals->setVerticalHeader(header);
-    confidence_intervals->higlight = &ci_hl;
+    if (reference>=0)
+    {
+        compared = QStringList() << header.at(reference);
+    }
+    
+    // dense pairwise tables over the memory budget are moved to mapped files
+    qint64 m = tests.length();
+    qint64 bytes = params->isJackknife() ? m * m * PV_BYTES : 0;
+    
+    // influence on pairwise differences has a column for every pair of tests
+    if (params->isJackknife())
+    {
+        bytes += (qint64)params->getInfluentialRows() * m * (m - 1) / 2 * PV_BYTES;
+    }
     
     for (int i=0; i<NRESULTS; i++)
     {
-        pc_pv[i] = new ResultsTable(permutation);
+        if (available_results[i])
+        {
+            bytes += m * compared.length() * (PV_BYTES + CI_BYTES);
+        }
+    }
+    
+    bool spill = !params->isSparse() && params->getMemoryBudget()>0 && bytes > (qint64)params->getMemoryBudget() * 1024 * 1024;
+    
+    for (int i=0; i<NRESULTS; i++)
+    {
+        pc_pv[i] = new ResultsTable(permutation, reference>=0);
         
-        pc_pv[i]->setHorizontalHeader(header);
-        pc_pv[i]->setVerticalHeader(header);
-        pc_pv[i]->higlight = &pc_hl[i];
+        pc_pv[i]->setHorizontalHeader(compared);
+        pc_pv[i]->setVerticalHeader(tests);
+        pc_pv[i]->setHighlight(pc_pv[i], params);
         
-        pc_ci[i] = new ResultsTable(permutation);
+        pc_ci[i] = new ResultsTable(permutation, reference>=0);
         
-        pc_ci[i]->setHorizontalHeader(header);
-        pc_ci[i]->setVerticalHeader(header);
-        pc_ci[i]->higlight = &pc_hl[i];
+        pc_ci[i]->setHorizontalHeader(compared);
+        pc_ci[i]->setVerticalHeader(tests);
+        pc_ci[i]->setHighlight(pc_pv[i], params);
+        
+        if (params->isSparse())
+        {
+            pc_pv[i]->setSparse(params->getSparseThreshold());
+            pc_ci[i]->setSparse(params->getSparseThreshold());
+        }
+        
+        pc_pv[i]->setSpill(spill, false);
+        pc_ci[i]->setSpill(spill);
+    }
+    
+    prevalence_ppv = new ResultsTable(permutation, true);
+    prevalence_ppv->setVerticalHeader(tests);
+    
+    prevalence_npv = new ResultsTable(permutation, true);
+    prevalence_npv->setVerticalHeader(tests);
+    
+    jackknife_se = new ResultsTable(permutation, true);
+    jackknife_se->setHorizontalHeader(measures);
+    jackknife_se->setVerticalHeader(tests);
+    
+    jackknife_pc = new ResultsTable(permutation);
+    jackknife_pc->setHorizontalHeader(tests);
+    jackknife_pc->setVerticalHeader(tests);
+    jackknife_pc->setSpill(spill, false);
+    
+    influence_order = new Permutation(params->getInfluentialRows());
+    
+    for (int i=0; i<NRESULTS; i++)
+    {
+        influence[i] = new ResultsTable(influence_order, true);
+        influence[i]->setHorizontalHeader(tests);
+    }
+    
+    QStringList pairs;
+    for (int i=0; i<tests.length(); i++)
+    {
+        for (int j=i+1; j<tests.length(); j++)
+        {
+            pairs << tests.at(i) + " - " + tests.at(j);
+        }
     }
+    
+    influence_pc = new ResultsTable(influence_order, true);
+    influence_pc->setHorizontalHeader(pairs);
+    influence_pc->setSpill(spill, false);
 }
 
 Results::~Results()
@@ -99,68 +224,162 @@ Results::~Results()
         delete pc_ci[i];
     }
     
+    delete prevalence_ppv;
+    delete prevalence_npv;
+    delete jackknife_se;
+    delete jackknife_pc;
+    for (int i=0; i<NRESULTS; i++)
+    {
+        delete influence[i];
+    }
+    delete influence_pc;
+    
+    delete influence_order;
+    
     delete permutation;
 }
 
-void Results::buildHighlightTable(ResultsTable *table, QList<BoolList> *hl_table)
+ResultsTable *Results::table(int id) const
 {
-    int n_rows = table->rowCount();
-    int n_cols = table->columnCount();
-    
-    hl_table->clear();
-    
-    double pvalue = params->getPvalue();
+    if (id==0)
+    {
+        return confidence_intervals;
+    }
     
-    for (int i=0; i<n_rows; i++)
+    if (id<NRESTOT)
     {
-        hl_table->append(BoolList());
-        
-        EntryList row = table->row(i);
-        
-        for (int j=0; j<n_cols; j++)
+        id = id - 1;
+        if (id%2==0)
+        {
+            return pc_pv[id/2];
+        }
+        else
         {
-            Entry e = row.at(j);
-            
-            if (e.type==PV)
-            {
-                if (e.value.at(EST) < pvalue)
-                {
-                    hl_table->last().append(true);
-                }
-                else
-                {
-                    hl_table->last().append(false);
-                }
-            }
-            else
-            {
-                hl_table->last().append(false);
-            }
+            return pc_ci[id/2];
         }
     }
+    
+    switch (id)
+    {
+    case PREVALENCE_PPV:
+        return prevalence_ppv;
+    case PREVALENCE_NPV:
+        return prevalence_npv;
+    case JACKKNIFE_SE:
+        return jackknife_se;
+    case JACKKNIFE_PC:
+        return jackknife_pc;
+    case INFLUENCE_PC:
+        return influence_pc;
+    }
+    
+    if (id>=INFLUENCE && id<INFLUENCE + NRESULTS)
+    {
+        return influence[id - INFLUENCE];
+    }
+    
+    return NULL;
 }
 
-void Results::buildHighlightTables()
+bool Results::hasTable(int id) const
 {
-    buildHighlightTable(confidence_intervals, &ci_hl);
-    for (int i=0; i<NRESULTS; i++)
+    if (id==0)
+    {
+        return true;
+    }
+    
+    if (id<NRESTOT)
     {
-        buildHighlightTable(pc_pv[i], &pc_hl[i]);
+        return available_results[(id - 1) / 2];
     }
+    
+    switch (id)
+    {
+    case PREVALENCE_PPV:
+        return params->isPrevalenceSweep() && available_results[PPV];
+    case PREVALENCE_NPV:
+        return params->isPrevalenceSweep() && available_results[NPV];
+    case JACKKNIFE_SE:
+        return params->isJackknife();
+    case JACKKNIFE_PC:
+    case INFLUENCE_PC:
+        return params->isJackknife() && available_results[params->getJackknifeMeasure()];
+    }
+    
+    if (id>=INFLUENCE && id<INFLUENCE + NRESULTS)
+    {
+        return params->isJackknife() && available_results[id - INFLUENCE];
+    }
+    
+    return false;
 }
 
-void Results::sortBy(int id)
+void Results::adjustPvalues()
 {
-    if (this->calculated)
+    int method = params->getAdjustment();
+    
+    if (method==NOADJUSTMENT)
     {
-        QList<double> column = confidence_intervals->column(id);
-        
-        permutation->sort(&column);
-        
-        emit resultsChanged();
+        return;
     }
-    else
+    
+    QList<ResultsTable*> tables;
+    for (int i=0; i<NRESULTS; i++)
+    {
+        if (available_results[i] && pairwise_calculated[i] && !pairwise_adjusted[i])
+        {
+            tables << pc_pv[i];
+            pairwise_adjusted[i] = true;
+        }
+    }
+    
+    // tables are independent, each is sorted in its own thread
+    QtConcurrent::blockingMap(tables, adjustment::TableAdjuster(method));
+}
+
+void Results::rank(const QList<RankKey> &keys, int top)
+{
+    if (!this->calculated)
     {
         return;
     }
+    
+    // keys read columns of confidence intervals in place
+    QVector<permutation::Key> columns;
+    
+    for (int k=0; k<keys.size(); k++)
+    {
+        permutation::Key key;
+        
+        if (keys.at(k).column<0 || keys.at(k).column>=confidence_intervals->columnCount())
+        {
+            continue;
+        }
+        
+        key.values = confidence_intervals->columnData(keys.at(k).column, keys.at(k).which);
+        key.stride = confidence_intervals->columnCount();
+        key.order = keys.at(k).order;
+        
+        if (key.values!=NULL)
+        {
+            columns.append(key);
+        }
+    }
+    
+    permutation->sort(columns, top);
+    
+    emit resultsChanged();
+}
+
+void Results::sortBy(int id)
+{
+    QList<RankKey> keys;
+    RankKey key;
+    
+    key.column = id;
+    key.which = EST;
+    key.order = DESCENDING;
+    keys << key;
+    
+    rank(keys);
 }
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "datatable.hpp"
 #include "resultstable.hpp"
 #include "permutation.hpp"
+#include "binarydata.hpp"
 
 const int ACC = 0;
 const int SEN = 1;
@@ -37,6 +38,47 @@ const int LRN = 6;
 const int NRESULTS = 7;
 const int NRESTOT  = 1 + NRESULTS * 2;
 
+//! ids of tables beyond confidence intervals and pairwise comparisons, see Results::table()
+const int PREVALENCE_PPV = NRESTOT;
+const int PREVALENCE_NPV = NRESTOT + 1;
+const int JACKKNIFE_SE = NRESTOT + 2;
+const int JACKKNIFE_PC = NRESTOT + 3;
+//! first of NRESULTS tables of influence, one per measure (ACC ... LRN)
+const int INFLUENCE    = NRESTOT + 4;
+const int INFLUENCE_PC = INFLUENCE + NRESULTS;
+
+const int NTABLES = INFLUENCE_PC + 1;
+
+//! names of tables, see Results::table()
+const QStringList RESULTS = (QStringList()
+                             << "Performance measures (point estimates and confidence intervals)"
+                             << "Pairwise accuracy p-value"
+                             << "Pairwise accuracy confidence intervals"
+                             << "Pairwise sensitivity p-value"
+                             << "Pairwise sensitivity confidence intervals"
+                             << "Pairwise specificity p-value"
+                             << "Pairwise specificity confidence intervals"
+                             << "Positive Predictive Value p-value"
+                             << "Positive Predictive Value confidence intervals"
+                             << "Negative Predictive Value p-value"
+                             << "Negative Predictive Value confidence intervals"
+                             << "Likelihood ratio of a positive test p-value"
+                             << "Likelihood ratio of a positive test confidence intervals"
+                             << "Likelihood ratio of a negative test p-value"
+                             << "Likelihood ratio of a negative test confidence intervals"
+                             << "Positive Predictive Value for a range of prevalences"
+                             << "Negative Predictive Value for a range of prevalences"
+                             << "Jackknife standard errors"
+                             << "Jackknife standard errors of pairwise differences"
+                             << "Most influential rows for diagnostic accuracy (jackknife influence)"
+                             << "Most influential rows for sensitivity (jackknife influence)"
+                             << "Most influential rows for specificity (jackknife influence)"
+                             << "Most influential rows for Positive Predictive Value (jackknife influence)"
+                             << "Most influential rows for Negative Predictive Value (jackknife influence)"
+                             << "Most influential rows for Likelihood ratio of a positive test (jackknife influence)"
+                             << "Most influential rows for Likelihood ratio of a negative test (jackknife influence)"
+                             << "Most influential rows for pairwise differences (jackknife influence)");
+
 //const int EST  = 0;
 //const int LOW  = 1;
 //const int UPP  = 2;
@@ -50,21 +92,89 @@ const QStringList HEADER = (QStringList()
                             << "Likelihood ratio of a positive test"
                             << "Likelihood ratio of a negative test");
 
+//! criterion of ranking of tests: column of confidence intervals, estimate or bound (EST, LOW, UPP) and order
+struct RankKey
+{
+    int column;
+    int which;
+    int order;
+};
+
 class Results : public QObject
 {
     Q_OBJECT
 public:
     explicit Results(DataTable *data, Params *params, QObject *parent = 0);
+    //! results for data with given column names (gold standard included)
+    Results(const QStringList &header, Params *params, QObject *parent = 0);
     ~Results();
     
-    QList<BoolList> ci_hl;
     ResultsTable* confidence_intervals;
     
-    QList<BoolList> pc_hl[NRESULTS];
     ResultsTable* pc_pv[NRESULTS];
     ResultsTable* pc_ci[NRESULTS];
     
-    void buildHighlightTable(ResultsTable *table, QList<BoolList> *hl_table);
+    //! predictive values for a grid of prevalences
+    ResultsTable* prevalence_ppv;
+    ResultsTable* prevalence_npv;
+    
+    //! jackknife standard errors of measures and of pairwise differences
+    ResultsTable* jackknife_se;
+    ResultsTable* jackknife_pc;
+    
+    //! influence of most influential rows on every measure of every test
+    ResultsTable* influence[NRESULTS];
+    
+    //! influence of most influential rows on pairwise differences of measure, see Params::getJackknifeMeasure()
+    ResultsTable* influence_pc;
+    
+    /*!
+      returns table with given id: 0 - confidence intervals, odd - pairwise
+      p-values, even - pairwise confidence intervals, PREVALENCE_PPV ...
+    */
+    ResultsTable *table(int id) const;
+    
+    //! is table with given id calculated for current params
+    bool hasTable(int id) const;
+    
+    /*!
+      returns column of data compared with every test or -1 if all pairs
+      are compared; pairwise tables of a reference have one column
+    */
+    int getReference() const
+    {
+        return reference;
+    }
+    
+    //! returns row of tables of the reference or -1 if all pairs are compared
+    int getReferenceTest() const
+    {
+        return reference_test;
+    }
+    
+    /*!
+      returns measures (see Params::getCaseToCalculate()) which can be
+      calculated with column gc of bits as gold standard: SENONLY if it has
+      only ones, SPEONLY if only zeros and ALL otherwise
+    */
+    static int caseToCalculate(const BinaryData &bits, int gc);
+    
+    /*!
+      replaces pairwise p-values with adjusted ones (see
+      Params::getAdjustment()), tables already adjusted are skipped
+    */
+    void adjustPvalues();
+    
+    //! are pairwise tables of measure x calculated
+    bool isPairwiseCalculated(int x) const
+    {
+        return pairwise_calculated[x];
+    }
+    
+    void setPairwiseCalculated(int x)
+    {
+        pairwise_calculated[x] = true;
+    }
     
     bool isAvailable(int x) const
     {
@@ -91,6 +201,13 @@ public:
         return calculated;
     }
     
+    /*!
+      orders tests by keys, next keys break ties of previous ones; if top is
+      not negative only the best top tests are ordered and views show only
+      them (see Permutation::shownCount())
+    */
+    void rank(const QList<RankKey> &keys, int top = -1);
+    
     void resetOrder()
     {
         permutation->resetToIdentity();
@@ -102,11 +219,19 @@ signals:
     void resultsChanged();
 
 public slots:
-    void buildHighlightTables();
-    
+    //! orders tests by estimate of measure id descending
     void sortBy(int id);
     
 private:
+    void init(const QStringList &header);
+    
+    int reference;
+    int reference_test;
+    
+    //! pairwise tables are calculated on demand, see Calculator::setLazy()
+    bool pairwise_calculated[NRESULTS];
+    bool pairwise_adjusted[NRESULTS];
+    
     DataTable *data;
     
     Params *params;
@@ -117,6 +242,9 @@ private:
     //! permutation for current order of diagnostic tests
     Permutation *permutation;
     
+    //! identity for rows of influence tables
+    Permutation *influence_order;
+    
     bool calculated;
 };
 
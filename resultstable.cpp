@@ -17,14 +17,359 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "resultstable.hpp"
+#include "formatter.hpp"
+
+#include <QtAlgorithms>
+#include <QDir>
+
+#include <climits>
+#include <cstring>
 
 ResultsTable::ResultsTable(Permutation *permutation, bool constant_columns, QObject *parent) :
     QAbstractTableModel(parent)
 {
     this->permutation = permutation;
     this->constant_columns = constant_columns;
+    this->significance = NULL;
+    this->params = NULL;
+    
+    this->n_rows = 0;
+    this->n_cols = 0;
+    this->shown_rows = -1;
+    
+    this->sparse = false;
+    this->sparse_threshold = 0.0;
+    this->last_row = -1;
+    this->n_entries = 0;
+    
+    this->spill = false;
+    this->spill_bounds = true;
+    this->backing = NULL;
+    this->mapped = NULL;
+    
+    updatePointers();
+    
+    for (int i=0; i<NINFO; i++)
+    {
+        info[i] = "";
+    }
+}
+
+ResultsTable::~ResultsTable()
+{
+    release();
+}
+
+void ResultsTable::setRowCount(int n_rows)
+{
+    beginResetModel();
+    
+    this->n_rows = n_rows;
+    this->n_cols = horizontal_header.length();
+    this->shown_rows = -1;
+    
+    release();
+    
+    low.clear();
+    upp.clear();
+    text_cache.clear();
+    
+    if (sparse)
+    {
+        types.clear();
+        est.clear();
+        row_start.fill(0, n_rows + 1);
+        columns.clear();
+        last_row = -1;
+        n_entries = 0;
+    }
+    else
+    {
+        qint64 cells = (qint64)n_rows * n_cols;
+        
+        if (cells > INT_MAX)
+        {
+            this->n_rows = 0;
+            cells = 0;
+        }
+        
+        n_entries = (int)cells;
+        
+        // estimates must be aligned to 8 bytes, bounds follow them only in tables of confidence intervals
+        qint64 types_size = (cells * sizeof(qint16) + 7) / 8 * 8;
+        qint64 size = types_size + (spill_bounds ? 3 : 1) * cells * sizeof(double);
+        
+        if (spill && cells>0)
+        {
+            backing = new QTemporaryFile(QDir::tempPath() + "/bdtcomparator");
+            
+            // file is extended without writing, so sections of values are zeros
+            if (backing->open() && backing->resize(size))
+            {
+                mapped = backing->map(0, size);
+            }
+            
+            if (mapped==NULL)
+            {
+                // no space for the file, keep entries on the heap
+                delete backing;
+                backing = NULL;
+            }
+        }
+        
+        if (mapped!=NULL)
+        {
+            types.clear();
+            est.clear();
+            
+            type_data = (qint16 *)mapped;
+            est_data = (double *)(mapped + types_size);
+            low_data = spill_bounds ? est_data + cells : NULL;
+            upp_data = spill_bounds ? low_data + cells : NULL;
+            
+            // EMPTY has all bits set
+            memset(type_data, 0xFF, cells * sizeof(qint16));
+        }
+        else
+        {
+            types.fill(EMPTY, n_entries);
+            est.fill(0.0, n_entries);
+        }
+    }
+    
+    if (mapped==NULL)
+    {
+        updatePointers();
+    }
+    
+    endResetModel();
+}
+
+void ResultsTable::updatePointers()
+{
+    type_data = types.data();
+    est_data = est.data();
+    low_data = low.isEmpty() ? NULL : low.data();
+    upp_data = upp.isEmpty() ? NULL : upp.data();
+}
+
+void ResultsTable::release()
+{
+    if (backing!=NULL)
+    {
+        if (mapped!=NULL)
+        {
+            backing->unmap(mapped);
+        }
+        
+        // temporary file is removed when deleted
+        delete backing;
+    }
+    
+    backing = NULL;
+    mapped = NULL;
+}
+
+void ResultsTable::set(int row, int col, int type, double est, double low, double upp)
+{
+    int k;
+    
+    if (sparse)
+    {
+        bool keep;
+        
+        if (type==PV)
+        {
+            keep = est < sparse_threshold;
+        }
+        else
+        {
+            keep = significance!=NULL && significance!=this && significance->find(row, col)>=0;
+        }
+        
+        if (!keep)
+        {
+            return;
+        }
+        
+        // rows between previous entry and this one are empty
+        while (last_row<row)
+        {
+            last_row++;
+            row_start[last_row] = types.size();
+        }
+        
+        k = n_entries;
+        n_entries++;
+        
+        types.append(type);
+        this->est.append(est);
+        columns.append(col);
+        
+        if (!this->low.isEmpty())
+        {
+            this->low.append(0.0);
+            this->upp.append(0.0);
+        }
+        
+        if (!text_cache.isEmpty())
+        {
+            text_cache.append(QString());
+        }
+        
+        updatePointers();
+    }
+    else
+    {
+        // rows of a table too large to be stored
+        if (row>=n_rows)
+        {
+            return;
+        }
+        
+        k = row * n_cols + col;
+        
+        type_data[k] = type;
+        est_data[k] = est;
+        
+        if (!text_cache.isEmpty())
+        {
+            text_cache[k] = QString();
+        }
+    }
+    
+    // only tables of confidence intervals need bounds
+    if (type==CI)
+    {
+        // types and estimates may be mapped, so only pointers of bounds are updated
+        if (low_data==NULL)
+        {
+            this->low.fill(0.0, n_entries);
+            this->upp.fill(0.0, n_entries);
+            low_data = this->low.data();
+            upp_data = this->upp.data();
+        }
+        
+        low_data[k] = low;
+        upp_data[k] = upp;
+    }
+}
+
+void ResultsTable::hideRows()
+{
+    beginResetModel();
+    
+    shown_rows = 0;
+    text_cache.clear();
+    
+    endResetModel();
+}
+
+void ResultsTable::showRows(int rows)
+{
+    if (shown_rows<0)
+    {
+        updateAll();
+        return;
+    }
+    
+    if (rows<0 || rows>n_rows)
+    {
+        rows = n_rows;
+    }
+    
+    if (rows>shown_rows)
+    {
+        beginInsertRows(QModelIndex(), shown_rows, rows - 1);
+        shown_rows = rows;
+        endInsertRows();
+    }
+    
+    // all rows are written, so their text may be cached again
+    if (shown_rows==n_rows)
+    {
+        shown_rows = -1;
+    }
+}
+
+int ResultsTable::find(int row, int col) const
+{
+    if (row>=n_rows)
+    {
+        return -1;
+    }
+    
+    if (!sparse)
+    {
+        return row * n_cols + col;
+    }
+    
+    // columns of a row are sorted
+    const int *first = columns.constData() + begin(row);
+    const int *last = columns.constData() + end(row);
+    const int *k = qLowerBound(first, last, col);
+    
+    if (k!=last && *k==col)
+    {
+        return k - columns.constData();
+    }
     
-    info[0] = "";
-    info[1] = "";
-    info[2] = "";
+    return -1;
+}
+
+QString ResultsTable::text(int row, int col) const
+{
+    int cell = find(row, col);
+    
+    if (cell<0 || type_data[cell]==EMPTY)
+    {
+        return QString("");
+    }
+    
+    // cache of a spilled table would take more memory than its entries, rows being written are not cached
+    bool cached = backing==NULL && shown_rows<0;
+    
+    if (cached && text_cache.isEmpty())
+    {
+        text_cache.resize(n_entries);
+    }
+    
+    if (!cached || text_cache.at(cell).isNull())
+    {
+        char buffer[4 * formatter::MAX_LENGTH];
+        int length = formatEntry(cell, buffer);
+        
+        if (!cached)
+        {
+            return QString::fromLatin1(buffer, length);
+        }
+        
+        text_cache[cell] = QString::fromLatin1(buffer, length);
+    }
+    
+    return text_cache.at(cell);
+}
+
+int ResultsTable::format(int row, int col, char *out) const
+{
+    int cell = find(row, col);
+    
+    if (cell<0 || type_data[cell]==EMPTY)
+    {
+        return 0;
+    }
+    
+    return formatEntry(cell, out);
+}
+
+int ResultsTable::formatEntry(int k, char *out) const
+{
+    if (type_data[k]==CI)
+    {
+        return formatter::interval(est_data[k], low_data[k], upp_data[k], out);
+    }
+    else
+    {
+        return formatter::fixed(est_data[k], 4, 0, out);
+    }
 }
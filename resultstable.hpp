@@ -23,34 +23,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStringList>
 #include <QVector>
 #include <QBrush>
+#include <QTemporaryFile>
 
+#include "params.hpp"
 #include "permutation.hpp"
 
 const int EMPTY = -1;
 const int PV  = 100;
 const int CI  = 200;
+const int NUM = 300;
 
 const int EST = 0;
 const int LOW = 1;
 const int UPP = 2;
 
-class Entry
-{
-public:
-    Entry(int type = EMPTY, QList<double> value = QList<double>())
-    {
-        this->type = type;
-        this->value = value;
-    }
-    
-    int type;
-    QList<double> value;
-};
-
-typedef QList<Entry> EntryList;
-typedef QList<bool> BoolList;
+//! number of info lines of a table
+const int NINFO = 4;
 
-const QString format = "%1 (%2;%3)";
+//! bytes of a dense entry of p-value (type and estimate) and confidence interval (and bounds)
+const int PV_BYTES = 10;
+const int CI_BYTES = 26;
 
 class ResultsTable : public QAbstractTableModel
 {
@@ -58,6 +50,7 @@ class ResultsTable : public QAbstractTableModel
     
 public:
     explicit ResultsTable(Permutation *permutation, bool constant_columns = false, QObject *parent = 0);
+    ~ResultsTable();
     
     int rowCount(const QModelIndex &parent=QModelIndex()) const
     {
@@ -67,9 +60,16 @@ public:
         }
         else
         {
-            return results.length();
+            // rows are tests (or influential rows) in order of permutation, only the best ones may be shown
+            return qMin(shown_rows<0 ? n_rows : shown_rows, permutation->shownCount());
         }
     }
+    
+    //! number of rows of stored entries, views may show fewer of them (see rowCount())
+    int storedRowCount() const
+    {
+        return n_rows;
+    }
 
     int columnCount(const QModelIndex &parent=QModelIndex()) const
     {
@@ -101,31 +101,11 @@ public:
         switch (role)
         {
         case Qt::DisplayRole:
-        {   
-            Entry e = results.at(row).at(col);
-            QString out;
-            
-            switch (e.type)
-            {
-            case PV:
-                out = QString::number(e.value.first(), 'f', 4);
-                break;
-            case CI:
-                out = format
-                        .arg(e.value.at(0), 6, 'f', 3)
-                        .arg(e.value.at(1), 6, 'f', 3)
-                        .arg(e.value.at(2), 6, 'f', 3);
-                break;
-            default:
-                out = "";
-            }
-
-            return QVariant(out);
-        }
+            return QVariant(text(row, col));
         case Qt::TextAlignmentRole:
             return QVariant(Qt::AlignCenter);
         case Qt::BackgroundRole:
-            if (higlight->at(row).at(col))
+            if (significance!=NULL && significance->isSignificant(row, col, params->getThreshold()))
             {
                 return QVariant(QBrush(QColor(170, 255, 170)));
             }
@@ -165,15 +145,141 @@ public:
         }
     }
     
-    void appendRow(EntryList row, const QModelIndex &parent=QModelIndex())
+    /*!
+      removes all rows and adds n_rows empty ones, views are reset only once;
+      entries are indexed by int, so a dense table of more entries is left
+      without rows (entries set to it are ignored)
+    */
+    void setRowCount(int n_rows);
+    
+    /*!
+      views show no rows until showRows() is called, so rows may be written
+      by another thread meanwhile (text of entries is not cached until all
+      rows are shown)
+    */
+    void hideRows();
+    
+    /*!
+      rows before rows are calculated: hidden ones are shown, all of them if
+      rows is negative; views of a table without hidden rows are updated
+    */
+    void showRows(int rows);
+    
+    /*!
+      stores entry, row and col are not permuted (no signals, see
+      setRowCount()); sparse tables need entries in order of rows and
+      columns and keep only interesting ones, see setSparse()
+    */
+    void set(int row, int col, int type, double est, double low = 0.0, double upp = 0.0);
+    
+    /*!
+      stores only p-values below threshold and entries present in table of
+      highlighting (see setHighlight()), rows are kept in compressed sparse
+      row format; must be called before setRowCount()
+    */
+    void setSparse(double threshold)
+    {
+        sparse = true;
+        sparse_threshold = threshold;
+    }
+    
+    bool isSparse() const
     {
-        int last = results.length();
+        return sparse;
+    }
+    
+    /*!
+      keeps entries of dense table in a memory-mapped temporary file instead
+      of the heap, so pages not shown or exported may be swapped out; the
+      file has room for bounds only if the table holds confidence intervals
+      (bounds of other tables are kept on the heap); must be called before
+      setRowCount()
+    */
+    void setSpill(bool spill, bool bounds = true)
+    {
+        this->spill = spill;
+        this->spill_bounds = bounds;
+    }
+    
+    //! are entries stored in a memory-mapped file
+    bool isSpilled() const
+    {
+        return backing!=NULL;
+    }
+    
+    //! returns index of stored entry or -1, row and col are not permuted
+    int find(int row, int col) const;
+    
+    //! first index of entries stored in row
+    int begin(int row) const
+    {
+        if (!sparse)
+        {
+            return row * n_cols;
+        }
         
-        beginInsertRows(parent, last, last);
+        return row<=last_row ? row_start.at(row) : n_entries;
+    }
+    
+    //! index after last entry stored in row
+    int end(int row) const
+    {
+        if (!sparse)
+        {
+            return (row + 1) * n_cols;
+        }
         
-        results.append(row);
+        return row<last_row ? row_start.at(row + 1) : n_entries;
+    }
+    
+    //! number of stored entries
+    int entryCount() const
+    {
+        return n_entries;
+    }
+    
+    /*!
+      returns values of all stored entries in order of storage (see begin()),
+      NULL for missing bounds
+    */
+    const double *entryData(int which=EST) const
+    {
+        return which==LOW ? low_data : (which==UPP ? upp_data : est_data);
+    }
+    
+    //! column of stored entry k
+    int columnAt(int k) const
+    {
+        return sparse ? columns.at(k) : k % n_cols;
+    }
+    
+    int typeAt(int k) const
+    {
+        return type_data[k];
+    }
+    
+    double valueAt(int k, int which=EST) const
+    {
+        switch (which)
+        {
+        case LOW:
+            return low_data[k];
+        case UPP:
+            return upp_data[k];
+        default:
+            return est_data[k];
+        }
+    }
+    
+    //! overwrites estimate of stored entry k
+    void setValueAt(int k, double value)
+    {
+        est_data[k] = value;
         
-        endInsertRows();
+        if (!text_cache.isEmpty())
+        {
+            text_cache[k] = QString();
+        }
     }
     
     void setHorizontalHeader(QStringList header)
@@ -186,25 +292,94 @@ public:
         vertical_header = header;
     }
     
-    EntryList row(int x) const
+    QStringList horizontalHeader() const
+    {
+        return horizontal_header;
+    }
+    
+    QStringList verticalHeader() const
+    {
+        return vertical_header;
+    }
+    
+    int type(int row, int col) const
+    {
+        int k = find(row, col);
+        
+        return k<0 ? EMPTY : type_data[k];
+    }
+    
+    double value(int row, int col, int which=EST) const
+    {
+        int k = find(row, col);
+        
+        return k<0 ? 0.0 : valueAt(k, which);
+    }
+    
+    //! overwrites estimate of entry, row and col are not permuted
+    void setValue(int row, int col, double value)
+    {
+        int k = find(row, col);
+        
+        if (k>=0)
+        {
+            setValueAt(k, value);
+        }
+    }
+    
+    //! returns displayed text of entry, row and col are not permuted
+    QString text(int row, int col) const;
+    
+    /*!
+      writes displayed text of entry to out (4 * formatter::MAX_LENGTH bytes
+      at least) and returns its length, row and col are not permuted
+    */
+    int format(int row, int col, char *out) const;
+    
+    //! returns row of entries shown in row of views
+    int sourceRow(int row) const
+    {
+        return permutation->at(row);
+    }
+    
+    //! returns column of entries shown in column of views
+    int sourceColumn(int col) const
+    {
+        return constant_columns ? col : permutation->at(col);
+    }
+    
+    //! is entry a p-value below threshold, row and col are not permuted
+    bool isSignificant(int row, int col, double threshold) const
     {
-        return results.at(x);
+        int k = find(row, col);
+        
+        return k>=0 && type_data[k]==PV && est_data[k] < threshold;
+    }
+    
+    //! highlights entries which are significant in table significance (at threshold of params)
+    void setHighlight(const ResultsTable *significance, const Params *params)
+    {
+        this->significance = significance;
+        this->params = params;
     }
     
-    QList<double> column(int x, int type=EST) const
+    /*!
+      returns values of column x of a dense table, value of row i is at
+      i * columnCount(); NULL for sparse tables and missing bounds
+    */
+    const double *columnData(int x, int which=EST) const
     {
-        QList<double> column;
+        const double *values = entryData(which);
         
-        for (int i=0; i<this->rowCount(); i++)
+        if (sparse || values==NULL)
         {
-            column.append(results.at(i).at(x).value.at(type));
+            return NULL;
         }
         
-        return column;
+        return values + x;
     }
     
-    QList<BoolList> *higlight;
-    QString info[3];
+    QString info[NINFO];
     
 signals:
 
@@ -229,10 +404,72 @@ public slots:
         this->dataChanged(top_left, bottom_right);
     }
     
+    //! views are reset, the order and number of shown rows may have changed (see Permutation::sort())
+    void updateOrder()
+    {
+        beginResetModel();
+        endResetModel();
+    }
+    
 private:
     Permutation *permutation;
     
-    QList<EntryList> results;
+    //! table of p-values deciding highlighting, NULL if not highlighted
+    const ResultsTable *significance;
+    const Params *params;
+    
+    int n_rows;
+    int n_cols;
+    
+    //! number of rows shown in views or -1 if all of them are, see hideRows()
+    int shown_rows;
+    
+    bool sparse;
+    double sparse_threshold;
+    
+    //! sparse tables: first entry of every row up to last_row and column of every entry
+    QVector<int> row_start;
+    QVector<int> columns;
+    int last_row;
+    
+    //! types and values of entries stored row after row
+    QVector<qint16> types;
+    QVector<double> est;
+    QVector<double> low;
+    QVector<double> upp;
+    
+    int n_entries;
+    
+    //! points the data pointers at vectors above (unless spilled)
+    void updatePointers();
+    
+    //! unmaps and removes backing file
+    void release();
+    
+    //! writes text of stored entry k, see format()
+    int formatEntry(int k, char *out) const;
+    
+    /*!
+      entries are read and written through these pointers, they point either
+      to vectors above or to sections of mapped backing file (types, estimates,
+      lower and upper bounds); low_data is NULL if there are no bounds
+    */
+    qint16 *type_data;
+    double *est_data;
+    double *low_data;
+    double *upp_data;
+    
+    bool spill;
+    bool spill_bounds;
+    QTemporaryFile *backing;
+    uchar *mapped;
+    
+    /*!
+      texts of cells filled when first displayed, they are stored in the
+      same order as values, so reordering of tests keeps them valid
+    */
+    mutable QVector<QString> text_cache;
+    
     QStringList vertical_header;
     QStringList horizontal_header;
     
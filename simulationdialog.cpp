@@ -0,0 +1,198 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "simulationdialog.hpp"
+#include "ui_simulationdialog.h"
+
+#include <QApplication>
+#include <QMessageBox>
+
+SimulationDialog::SimulationDialog(Params *params, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::SimulationDialog)
+{
+    ui->setupUi(this);
+    
+    this->params = params;
+    this->simulator = NULL;
+    
+    ui->metricComboBox->addItems(HEADER);
+    
+    QObject::connect(ui->metricComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(showPower(int)));
+}
+
+SimulationDialog::~SimulationDialog()
+{
+    delete ui;
+    
+    if (simulator!=NULL)
+    {
+        delete simulator;
+    }
+}
+
+void SimulationDialog::setScenario(const Scenario &scenario)
+{
+    ui->subjectsSpinBox->setValue(scenario.subjects);
+    ui->prevalenceSpinBox->setValue(scenario.prevalence);
+    ui->correlationSpinBox->setValue(scenario.correlation);
+    
+    ui->testsTable->setRowCount(0);
+    
+    for (int k=0; k<scenario.names.length(); k++)
+    {
+        appendTest(scenario.names.at(k), scenario.sensitivity.at(k), scenario.specificity.at(k));
+    }
+}
+
+Scenario SimulationDialog::scenario() const
+{
+    Scenario output;
+    
+    output.subjects = ui->subjectsSpinBox->value();
+    output.prevalence = ui->prevalenceSpinBox->value();
+    output.correlation = ui->correlationSpinBox->value();
+    
+    for (int k=0; k<ui->testsTable->rowCount(); k++)
+    {
+        output.names << ui->testsTable->item(k, 0)->text();
+        output.sensitivity << ui->testsTable->item(k, 1)->text().toDouble();
+        output.specificity << ui->testsTable->item(k, 2)->text().toDouble();
+    }
+    
+    return output;
+}
+
+void SimulationDialog::appendTest(const QString &name, double se, double sp)
+{
+    int row = ui->testsTable->rowCount();
+    
+    ui->testsTable->insertRow(row);
+    ui->testsTable->setItem(row, 0, new QTableWidgetItem(name));
+    ui->testsTable->setItem(row, 1, new QTableWidgetItem(QString::number(se, 'f', 4)));
+    ui->testsTable->setItem(row, 2, new QTableWidgetItem(QString::number(sp, 'f', 4)));
+}
+
+void SimulationDialog::on_addButton_clicked()
+{
+    appendTest("Test " + QString::number(ui->testsTable->rowCount() + 1), 0.8, 0.8);
+}
+
+void SimulationDialog::on_removeButton_clicked()
+{
+    int row = ui->testsTable->currentRow();
+    
+    if (row>=0)
+    {
+        ui->testsTable->removeRow(row);
+    }
+}
+
+void SimulationDialog::on_runButton_clicked()
+{
+    Scenario s = scenario();
+    
+    if (s.names.length()<2)
+    {
+        QMessageBox msgBox;
+        msgBox.setText("Simulate at least 2 tests.");
+        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.exec();
+        
+        return;
+    }
+    
+    ui->powerView->setModel(NULL);
+    
+    if (simulator!=NULL)
+    {
+        delete simulator;
+    }
+    
+    simulator = new Simulator(s, params);
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    simulator->power(ui->simulationsSpinBox->value());
+    QApplication::restoreOverrideCursor();
+    
+    ui->sampleSizeButton->setEnabled(true);
+    
+    showPower(ui->metricComboBox->currentIndex());
+}
+
+void SimulationDialog::on_sampleSizeButton_clicked()
+{
+    QModelIndex index = ui->powerView->currentIndex();
+    
+    if (simulator==NULL || !index.isValid() || index.row()==index.column())
+    {
+        QMessageBox msgBox;
+        msgBox.setText("Select a pair of tests in the power table.");
+        msgBox.setIcon(QMessageBox::Information);
+        msgBox.exec();
+        
+        return;
+    }
+    
+    int metric = ui->metricComboBox->currentIndex();
+    double target = ui->targetPowerSpinBox->value();
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    int n = simulator->sampleSize(metric, index.row(), index.column(), target, ui->simulationsSpinBox->value(), ui->subjectsSpinBox->maximum());
+    QApplication::restoreOverrideCursor();
+    
+    Scenario s = scenario();
+    
+    QString message;
+    
+    if (n<0)
+    {
+        message = "Power of %1 for %2 of %3 and %4 is not reached with %5 subjects.";
+        message = message.arg(QString::number(target, 'f', 2), HEADER[metric].toLower(), s.names.at(index.row()), s.names.at(index.column()), QString::number(ui->subjectsSpinBox->maximum()));
+    }
+    else
+    {
+        message = "%1 subjects give power of at least %2 for %3 of %4 and %5.";
+        message = message.arg(QString::number(n), QString::number(target, 'f', 2), HEADER[metric].toLower(), s.names.at(index.row())).arg(s.names.at(index.column()));
+    }
+    
+    QMessageBox msgBox;
+    msgBox.setText(message);
+    msgBox.setIcon(QMessageBox::Information);
+    msgBox.exec();
+}
+
+void SimulationDialog::on_buttonBox_rejected()
+{
+    this->hide();
+}
+
+void SimulationDialog::showPower(int metric)
+{
+    if (simulator==NULL || metric<0)
+    {
+        return;
+    }
+    
+    ResultsTable *table = simulator->table(metric);
+    
+    ui->powerView->setModel(table);
+    ui->powerView->resizeColumnsToContents();
+    
+    ui->infoLabel->setText(table->info[0] + "\n" + table->info[1] + "\n" + table->info[2]);
+}
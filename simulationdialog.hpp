@@ -0,0 +1,63 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIMULATIONDIALOG_HPP
+#define SIMULATIONDIALOG_HPP
+
+#include <QDialog>
+
+#include "params.hpp"
+#include "simulator.hpp"
+
+namespace Ui {
+    class SimulationDialog;
+}
+
+class SimulationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationDialog(Params *params, QWidget *parent = 0);
+    ~SimulationDialog();
+    
+    //! fills the form with scenario
+    void setScenario(const Scenario &scenario);
+
+private slots:
+    void on_addButton_clicked();
+    void on_removeButton_clicked();
+    void on_runButton_clicked();
+    void on_sampleSizeButton_clicked();
+    void on_buttonBox_rejected();
+    
+    void showPower(int metric);
+
+private:
+    //! returns scenario from the form
+    Scenario scenario() const;
+    
+    void appendTest(const QString &name, double se, double sp);
+    
+    Ui::SimulationDialog *ui;
+    
+    Params *params;
+    Simulator *simulator;
+};
+
+#endif // SIMULATIONDIALOG_HPP
@@ -0,0 +1,269 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "simulator.hpp"
+#include "calculator.hpp"
+
+#include <QtConcurrentMap>
+
+#include <boost/math/distributions/normal.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
+
+simulation::Run::Run(const Simulator *simulator, int subjects)
+{
+    this->simulator = simulator;
+    this->subjects = subjects;
+}
+
+QVector<int> simulation::Run::operator()(const int &seed) const
+{
+    return simulator->simulate(seed, subjects);
+}
+
+void simulation::addHits(QVector<int> &total, const QVector<int> &hits)
+{
+    if (total.isEmpty())
+    {
+        total = hits;
+        return;
+    }
+
+    for (int k=0; k<hits.size(); k++)
+    {
+        total[k] += hits.at(k);
+    }
+}
+
+Simulator::Simulator(const Scenario &scenario, const Params *params, QObject *parent) :
+    QObject(parent)
+{
+    this->scenario = scenario;
+    this->params = params;
+    this->n_tests = scenario.names.length();
+
+    boost::math::normal normal;
+
+    for (int k=0; k<n_tests; k++)
+    {
+        double se = qBound(1e-9, scenario.sensitivity.at(k), 1.0 - 1e-9);
+        double sp = qBound(1e-9, scenario.specificity.at(k), 1.0 - 1e-9);
+
+        // diseased subject is positive below se threshold, healthy one above sp threshold
+        se_threshold.append(boost::math::quantile(normal, se));
+        sp_threshold.append(boost::math::quantile(normal, sp));
+    }
+
+    permutation = new Permutation(n_tests);
+
+    for (int i=0; i<NRESULTS; i++)
+    {
+        power_tables[i] = new ResultsTable(permutation);
+        power_tables[i]->setHorizontalHeader(scenario.names);
+        power_tables[i]->setVerticalHeader(scenario.names);
+    }
+}
+
+Simulator::~Simulator()
+{
+    for (int i=0; i<NRESULTS; i++)
+    {
+        delete power_tables[i];
+    }
+
+    delete permutation;
+}
+
+BinaryData Simulator::cohort(int seed, int subjects) const
+{
+    BinaryData output(subjects, n_tests + 1);
+
+    boost::random::mt19937 generator(seed);
+    boost::random::uniform_01<double> uniform;
+    boost::random::normal_distribution<double> normal;
+
+    double shared = sqrt(scenario.correlation);
+    double own = sqrt(1.0 - scenario.correlation);
+
+    for (int s=0; s<subjects; s++)
+    {
+        bool diseased = uniform(generator) < scenario.prevalence;
+
+        output.set(s, 0, diseased);
+
+        double common = normal(generator);
+
+        for (int k=0; k<n_tests; k++)
+        {
+            double z = shared * common + own * normal(generator);
+
+            if (diseased ? z < se_threshold.at(k) : z > sp_threshold.at(k))
+            {
+                output.set(s, k + 1);
+            }
+        }
+    }
+
+    return output;
+}
+
+QVector<int> Simulator::simulate(int seed, int subjects) const
+{
+    QStringList header;
+    header << "Gold standard" << scenario.names;
+
+    // Monte Carlo Cochran's Q and optional tables are not needed for power of pairwise comparisons
+    Params local;
+    local.assign(params);
+    local.setGoldStandard(0);
+
+    // reference is a column of loaded data, all pairs of simulated tests are compared
+    local.setReference(-1);
+
+    // every significant pair is counted and small tables of cohorts stay on the heap
+    local.setSparse(false);
+    local.setMemoryBudget(0);
+    local.setCaseToCalculate(ALL);
+    local.setPermutations(0);
+    local.setPrevalenceSweep(false);
+    local.setJackknife(false);
+
+    Results results(header, &local);
+    Calculator calculator(NULL, &results, &local);
+
+    calculator.calculate(cohort(seed, subjects));
+
+    int m = n_tests;
+    double alpha = local.getPvalue();
+
+    QVector<int> hits(NRESULTS * m * m, 0);
+
+    for (int metric=0; metric<NRESULTS; metric++)
+    {
+        const ResultsTable *table = results.pc_pv[metric];
+
+        for (int i=0; i<table->storedRowCount(); i++)
+        {
+            for (int j=0; j<m; j++)
+            {
+                if (table->type(i, j)==PV && table->value(i, j) < alpha)
+                {
+                    hits[(metric * m + i) * m + j] = 1;
+                }
+            }
+        }
+    }
+
+    return hits;
+}
+
+QVector<int> Simulator::significant(int simulations, int subjects) const
+{
+    QList<int> seeds;
+
+    for (int s=0; s<simulations; s++)
+    {
+        seeds << s + 1;
+    }
+
+    return QtConcurrent::blockingMappedReduced(seeds, simulation::Run(this, subjects), simulation::addHits);
+}
+
+void Simulator::power(int simulations)
+{
+    int m = n_tests;
+
+    QVector<int> hits = significant(simulations, scenario.subjects);
+
+    for (int metric=0; metric<NRESULTS; metric++)
+    {
+        ResultsTable *table = new ResultsTable(permutation);
+        table->setHorizontalHeader(scenario.names);
+        table->setVerticalHeader(scenario.names);
+
+        table->setRowCount(m);
+
+        for (int i=0; i<m; i++)
+        {
+            for (int j=0; j<m; j++)
+            {
+                if (i==j || hits.isEmpty())
+                {
+                    continue;
+                }
+
+                table->set(i, j, NUM, (double)hits.at((metric * m + i) * m + j) / simulations);
+            }
+        }
+
+        table->info[0] = "Subjects    = " + QString::number(scenario.subjects);
+        table->info[1] = "Simulations = " + QString::number(simulations);
+        table->info[2] = "Alpha       = " + QString::number(params->getPvalue(), 'f', 4);
+
+        delete power_tables[metric];
+        power_tables[metric] = table;
+    }
+}
+
+int Simulator::sampleSize(int metric, int i, int j, double target, int simulations, int max_subjects)
+{
+    int m = n_tests;
+    int id = (metric * m + i) * m + j;
+
+    int low = 0;
+    int high = qMax(scenario.subjects, 10);
+
+    // grow until power is reached
+    while (true)
+    {
+        QVector<int> hits = significant(simulations, high);
+
+        if ((double)hits.at(id) / simulations >= target)
+        {
+            break;
+        }
+
+        if (high>=max_subjects)
+        {
+            return -1;
+        }
+
+        low = high;
+        high = qMin(2 * high, max_subjects);
+    }
+
+    // bisection up to 1% of the number of subjects
+    while (high - low > qMax(1, high / 100))
+    {
+        int middle = (low + high) / 2;
+
+        QVector<int> hits = significant(simulations, middle);
+
+        if ((double)hits.at(id) / simulations >= target)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+
+    return high;
+}
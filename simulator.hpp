@@ -0,0 +1,121 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "params.hpp"
+#include "binarydata.hpp"
+#include "results.hpp"
+#include "resultstable.hpp"
+#include "permutation.hpp"
+
+//! design of a simulated validation study
+struct Scenario
+{
+    int subjects;
+    double prevalence;
+    //! correlation of latent normal variables of tests (given disease status)
+    double correlation;
+
+    QStringList names;
+    QVector<double> sensitivity;
+    QVector<double> specificity;
+};
+
+class Simulator;
+
+namespace simulation
+{
+    //! one simulated study, returns numbers of significant comparisons
+    struct Run
+    {
+        typedef QVector<int> result_type;
+
+        Run(const Simulator *simulator, int subjects);
+
+        QVector<int> operator()(const int &seed) const;
+
+        const Simulator *simulator;
+        int subjects;
+    };
+
+    void addHits(QVector<int> &total, const QVector<int> &hits);
+}
+
+/*!
+  Generates synthetic cohorts for given prevalence, sensitivities,
+  specificities and correlation of tests and runs Calculator on each of them
+  to estimate power of pairwise comparisons.
+*/
+class Simulator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Simulator(const Scenario &scenario, const Params *params, QObject *parent = 0);
+    ~Simulator();
+
+    //! generates one synthetic cohort, gold standard is in the first column
+    BinaryData cohort(int seed, int subjects) const;
+
+    //! returns for every metric and pair of tests 1 if comparison was significant
+    QVector<int> simulate(int seed, int subjects) const;
+
+    //! estimates power of all pairwise comparisons, see table()
+    void power(int simulations);
+
+    /*!
+      returns smallest number of subjects for which power of comparison of
+      tests i and j is at least target or -1 if it exceeds max_subjects
+    */
+    int sampleSize(int metric, int i, int j, double target, int simulations, int max_subjects);
+
+    //! returns table of estimated power for metric
+    ResultsTable *table(int metric) const
+    {
+        return power_tables[metric];
+    }
+
+    int numberOfTests() const
+    {
+        return n_tests;
+    }
+
+private:
+    //! returns numbers of significant comparisons in simulations
+    QVector<int> significant(int simulations, int subjects) const;
+
+    Scenario scenario;
+
+    const Params *params;
+
+    int n_tests;
+
+    //! thresholds of latent variables for diseased and healthy subjects
+    QVector<double> se_threshold;
+    QVector<double> sp_threshold;
+
+    Permutation *permutation;
+    ResultsTable *power_tables[NRESULTS];
+};
+
+#endif // SIMULATOR_HPP
@@ -0,0 +1,151 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "strata.hpp"
+
+#include <QHash>
+#include <QVector>
+
+QList<int> strata::columns(const DataTable *data)
+{
+    QList<int> output;
+
+    for (int j=0; j<data->columnCount(); j++)
+    {
+        if (data->isStratum(j))
+        {
+            output << j;
+        }
+    }
+
+    return output;
+}
+
+QStringList strata::header(const DataTable *data)
+{
+    QStringList output;
+    QStringList names = data->getHeader();
+
+    for (int j=0; j<names.length(); j++)
+    {
+        if (!data->isStratum(j))
+        {
+            output << names.at(j);
+        }
+    }
+
+    return output;
+}
+
+BinaryData strata::split(const DataTable *data, QList<Group> *groups)
+{
+    int n_rows = data->rowCount();
+
+    QList<int> stratum_columns = columns(data);
+    QStringList names = data->getHeader();
+
+    QVector<int> tests;
+
+    for (int j=0; j<data->columnCount(); j++)
+    {
+        if (!data->isStratum(j))
+        {
+            tests << j;
+        }
+    }
+
+    // the first pass finds group of every row and sizes of groups
+    QHash<QString, int> index;
+    QStringList keys;
+    QVector<int> group_of_row(n_rows, -1);
+    QVector<int> sizes;
+    int n_active = 0;
+
+    for (int i=0; i<n_rows; i++)
+    {
+        if (!data->isActive(i))
+        {
+            continue;
+        }
+
+        QStringList row = data->row(i);
+        QStringList values;
+
+        for (int s=0; s<stratum_columns.length(); s++)
+        {
+            int j = stratum_columns.at(s);
+            values << names.at(j) + "=" + row.at(j).simplified();
+        }
+
+        QString key = values.join(", ");
+
+        if (!index.contains(key))
+        {
+            index.insert(key, keys.length());
+            keys << key;
+            sizes << 0;
+        }
+
+        group_of_row[i] = index.value(key);
+        sizes[group_of_row[i]]++;
+        n_active++;
+    }
+
+    groups->clear();
+
+    for (int g=0; g<keys.length(); g++)
+    {
+        Group group;
+        group.name = keys.at(g);
+        group.bits = BinaryData(sizes.at(g), tests.size());
+
+        groups->append(group);
+    }
+
+    // the second pass packs every row into all rows and its group
+    BinaryData output(n_active, tests.size());
+    QVector<int> filled(keys.length(), 0);
+    int r = 0;
+
+    for (int i=0; i<n_rows; i++)
+    {
+        int g = group_of_row.at(i);
+
+        if (g<0)
+        {
+            continue;
+        }
+
+        QStringList row = data->row(i);
+        BinaryData &bits = (*groups)[g].bits;
+
+        for (int k=0; k<tests.size(); k++)
+        {
+            if (row.at(tests.at(k)).simplified()=="1")
+            {
+                output.set(r, k);
+                bits.set(filled.at(g), k);
+            }
+        }
+
+        filled[g]++;
+        r++;
+    }
+
+    return output;
+}
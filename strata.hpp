@@ -0,0 +1,59 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STRATA_HPP
+#define STRATA_HPP
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "datatable.hpp"
+#include "binarydata.hpp"
+
+/*!
+  Subgroup analysis: active rows of data are grouped by values of stratum
+  columns (e.g. site, age band or device, see Params::getStrata()), which
+  are not tests and may hold any values. Every group is packed on its own,
+  so counts of pairs and triples of its columns (see Cooccurrence) are
+  counted once per group, and counts of all rows pooled are their sums.
+*/
+namespace strata
+{
+    //! rows with the same values of stratum columns
+    struct Group
+    {
+        //! values of stratum columns, e.g. "site=A, age=40-49"
+        QString name;
+        BinaryData bits;
+    };
+
+    //! returns stratum columns of data, see DataTable::isStratum()
+    QList<int> columns(const DataTable *data);
+
+    //! returns header of data without stratum columns
+    QStringList header(const DataTable *data);
+
+    /*!
+      packs active rows of data without stratum columns into groups (in
+      order of first row of every group), returns all of them packed
+    */
+    BinaryData split(const DataTable *data, QList<Group> *groups);
+}
+
+#endif // STRATA_HPP
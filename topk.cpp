@@ -0,0 +1,213 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "topk.hpp"
+#include "permutationtest.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/math/distributions/chi_squared.hpp>
+
+namespace topk
+{
+    //! column of data and its number of ones
+    struct Column
+    {
+        int x;
+        int sum;
+
+        bool operator<(const Column &other) const
+        {
+            return sum < other.sum;
+        }
+    };
+
+    //! pair of positions p < q of sorted columns
+    struct Candidate
+    {
+        int p;
+        int q;
+        int difference;
+
+        //! candidates with larger difference come first out of the heap
+        bool operator<(const Candidate &other) const
+        {
+            return difference < other.difference;
+        }
+    };
+
+    //! orders pairs from the best one, the worst is on top of the heap
+    struct Better
+    {
+        Better(int key)
+        {
+            this->key = key;
+        }
+
+        bool operator()(const Pair &a, const Pair &b) const
+        {
+            if (key==SMALLEST_PVALUE)
+            {
+                return a.pvalue < b.pvalue || (a.pvalue==b.pvalue && a.difference > b.difference);
+            }
+
+            return a.difference > b.difference || (a.difference==b.difference && a.pvalue < b.pvalue);
+        }
+
+        int key;
+    };
+
+    Candidate candidate(const QVector<Column> &columns, int p, int q)
+    {
+        Candidate output;
+
+        output.p = p;
+        output.q = q;
+        output.difference = columns.at(q).sum - columns.at(p).sum;
+
+        return output;
+    }
+
+    //! lowest p-value of any pair with at most given difference of column sums
+    double lowestPvalue(int difference, bool exact)
+    {
+        if (exact)
+        {
+            return permutationtest::mcnemar(difference, 0.0);
+        }
+
+        // with b + c discordant pairs statistic is (|b - c| - 1)^2 / (b + c), for b = c it is at most 1/2
+        double d = difference;
+        double statistic = difference>=2 ? (d - 1.0) * (d - 1.0) / d : 0.5;
+
+        boost::math::chi_squared chisq1(1);
+
+        return 1.0 - boost::math::cdf(chisq1, statistic);
+    }
+}
+
+double topk::mcnemar(double b, double c, bool exact)
+{
+    if (exact)
+    {
+        return permutationtest::mcnemar(b, c);
+    }
+
+    if (b+c<1.0)
+    {
+        return 1.0;
+    }
+
+    double statistic = fabs(b - c) - 1.0;
+    statistic = statistic * statistic / (b + c);
+
+    boost::math::chi_squared chisq1(1);
+
+    return 1.0 - boost::math::cdf(chisq1, statistic);
+}
+
+QVector<topk::Pair> topk::query(const BinaryData *input, int gc, int k, int key, bool exact)
+{
+    QVector<Column> columns;
+
+    for (int x=0; x<input->columnCount(); x++)
+    {
+        if (x==gc)
+        {
+            continue;
+        }
+
+        Column column;
+        column.x = x;
+        column.sum = input->count(x);
+
+        columns.append(column);
+    }
+
+    std::sort(columns.begin(), columns.end());
+
+    int m = columns.size();
+    double n = input->rowCount();
+
+    QVector<Pair> best;
+
+    if (k<=0 || m<2)
+    {
+        return best;
+    }
+
+    Better better(key);
+
+    QVector<Candidate> candidates;
+    candidates.append(candidate(columns, 0, m - 1));
+
+    while (!candidates.isEmpty())
+    {
+        std::pop_heap(candidates.begin(), candidates.end());
+        Candidate next = candidates.last();
+        candidates.resize(candidates.size() - 1);
+
+        // all pairs left differ by at most next.difference
+        if (best.size()==k)
+        {
+            if (key==LARGEST_DIFFERENCE || lowestPvalue(next.difference, exact) >= best.first().pvalue)
+            {
+                break;
+            }
+        }
+
+        // every pair is reached once: (0, q) from (0, q + 1), (p, q) from (p - 1, q)
+        if (next.p + 1 < next.q)
+        {
+            candidates.append(candidate(columns, next.p + 1, next.q));
+            std::push_heap(candidates.begin(), candidates.end());
+        }
+
+        if (next.p==0 && next.q - 1 > 0)
+        {
+            candidates.append(candidate(columns, 0, next.q - 1));
+            std::push_heap(candidates.begin(), candidates.end());
+        }
+
+        Pair pair;
+        pair.i = columns.at(next.q).x;
+        pair.j = columns.at(next.p).x;
+        pair.difference = next.difference / n;
+
+        double both = input->countBoth(pair.i, pair.j);
+        pair.pvalue = mcnemar(columns.at(next.q).sum - both, columns.at(next.p).sum - both, exact);
+
+        if (best.size()<k)
+        {
+            best.append(pair);
+            std::push_heap(best.begin(), best.end(), better);
+        }
+        else if (better(pair, best.first()))
+        {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.last() = pair;
+            std::push_heap(best.begin(), best.end(), better);
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end(), better);
+
+    return best;
+}
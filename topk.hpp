@@ -0,0 +1,60 @@
+/*
+Binary Diagnostic Tests Comparator
+Copyright (C) 2011 Damian Fijorek (damianfijorek@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TOPK_HPP
+#define TOPK_HPP
+
+#include <QVector>
+
+#include "binarydata.hpp"
+
+//! keys of top-k queries
+const int SMALLEST_PVALUE = 0;
+const int LARGEST_DIFFERENCE = 1;
+
+/*!
+  Top-k queries over pairs of tests without filling pairwise tables.
+  Difference of proportions of two tests depends only on their column sums
+  and McNemar statistic is largest when all discordant pairs go one way, so
+  pairs are visited in decreasing order of |colsum_i - colsum_j| and the
+  search stops when this bound cannot beat the k-th best pair found.
+*/
+namespace topk
+{
+    //! pair of columns, test i has the larger proportion of ones
+    struct Pair
+    {
+        int i;
+        int j;
+        double difference;
+        double pvalue;
+    };
+
+    //! McNemar p-value (exact or asymptotic as in pairwise tables) of b and c discordant pairs
+    double mcnemar(double b, double c, bool exact);
+
+    /*!
+      returns k pairs of columns of input (gold standard gc skipped) with
+      smallest McNemar p-values or largest differences of proportions, best
+      first
+    */
+    QVector<Pair> query(const BinaryData *input, int gc, int k, int key, bool exact);
+}
+
+#endif // TOPK_HPP